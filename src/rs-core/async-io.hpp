@@ -0,0 +1,566 @@
+#pragma once
+
+#include "rs-core/io.hpp"
+#include "rs-core/thread-pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+
+    #include <sys/mman.h>
+    #include <unistd.h>
+
+    #if defined(__linux__) && __has_include(<linux/io_uring.h>)
+        #define RS_CORE_IO_URING 1
+        #include <linux/io_uring.h>
+        #include <sys/syscall.h>
+    #endif
+
+#endif
+
+namespace RS {
+
+    #ifndef _WIN32
+
+        class AsyncIO {
+
+        public:
+
+            enum class backend: int {
+                automatic,
+                io_uring,
+                thread_pool,
+            };
+
+            struct result {
+                std::size_t bytes = 0;
+                std::error_code error;
+            };
+
+            using callback = std::function<void(const result&)>;
+
+            static constexpr std::size_t default_entries = 256;
+
+            AsyncIO(): AsyncIO{default_entries} {}
+            explicit AsyncIO(std::size_t entries, backend mode = backend::automatic);
+            explicit AsyncIO(ThreadPool& pool, std::size_t entries = default_entries, backend mode = backend::automatic);
+            ~AsyncIO() noexcept;
+            AsyncIO(const AsyncIO&) = delete;
+            AsyncIO(AsyncIO&&) = delete;
+            AsyncIO& operator=(const AsyncIO&) = delete;
+            AsyncIO& operator=(AsyncIO&&) = delete;
+
+            backend active_backend() const noexcept { return backend_; }
+            std::size_t capacity() const noexcept { return slots_.size(); }
+            std::size_t pending() const noexcept { return queue_.size() + in_flight_; }
+            std::size_t poll() { return reap(0); }
+            void read(Fdio& io, void* ptr, std::size_t len, std::ptrdiff_t offset, callback call = {});
+            std::size_t submit();
+            std::size_t wait(std::size_t count = 1);
+            void wait_all();
+            void write(Fdio& io, const void* ptr, std::size_t len, std::ptrdiff_t offset, callback call = {});
+
+        private:
+
+            struct operation {
+                bool writing = false;
+                int fd = -1;
+                void* ptr = nullptr;
+                std::size_t len = 0;
+                std::ptrdiff_t offset = 0;
+                callback call;
+            };
+
+            struct completion {
+                std::size_t slot;
+                result res;
+            };
+
+            backend backend_ = backend::thread_pool;
+            std::vector<operation> slots_;
+            std::vector<std::size_t> free_slots_;
+            std::deque<std::size_t> queue_;
+            std::size_t in_flight_ = 0;
+            ThreadPool* work_pool_ = nullptr;
+            std::unique_ptr<TaskGroup> callbacks_;
+            std::mutex mutex_;
+            std::condition_variable cv_;
+            std::vector<completion> done_;
+            std::unique_ptr<ThreadPool> own_pool_;
+
+            void enqueue(operation op);
+            void init(std::size_t entries, backend mode);
+            std::size_t reap(std::size_t min_count);
+            void release_slot(completion& c);
+            std::size_t submit_pool();
+            std::size_t collect_pool(std::vector<completion>& out, std::size_t min_count);
+
+            static result perform(const operation& op) noexcept;
+
+            #ifdef RS_CORE_IO_URING
+
+                struct uring {
+                    int fd = -1;
+                    void* sq_map = nullptr;
+                    std::size_t sq_map_size = 0;
+                    ::io_uring_sqe* sqes = nullptr;
+                    std::size_t sqes_size = 0;
+                    unsigned* sq_head = nullptr;
+                    unsigned* sq_tail = nullptr;
+                    unsigned* sq_array = nullptr;
+                    unsigned sq_mask = 0;
+                    unsigned sq_entries = 0;
+                    unsigned* cq_head = nullptr;
+                    unsigned* cq_tail = nullptr;
+                    ::io_uring_cqe* cqes = nullptr;
+                    unsigned cq_mask = 0;
+                    unsigned unsubmitted = 0;
+                };
+
+                uring ring_;
+
+                bool open_ring(std::size_t entries) noexcept;
+                void close_ring() noexcept;
+                int enter(unsigned to_submit, unsigned min_complete, unsigned flags) noexcept;
+                std::size_t submit_ring();
+                std::size_t collect_ring(std::vector<completion>& out, std::size_t min_count);
+
+            #endif
+
+        };
+
+            inline AsyncIO::AsyncIO(std::size_t entries, backend mode) {
+                init(entries, mode);
+            }
+
+            inline AsyncIO::AsyncIO(ThreadPool& pool, std::size_t entries, backend mode):
+            work_pool_{&pool},
+            callbacks_{std::make_unique<TaskGroup>(pool)} {
+                init(entries, mode);
+            }
+
+            inline AsyncIO::~AsyncIO() noexcept {
+
+                // The kernel or a pool thread may still be using the buffers,
+                // so wait for everything already submitted before returning.
+                // Operations that were never submitted are discarded. If
+                // collecting completions keeps failing without making any
+                // progress, give up rather than spin forever
+
+                static constexpr int max_failures = 16;
+
+                queue_.clear();
+
+                for (auto failures = 0; in_flight_ > 0 && failures < max_failures;) {
+                    auto before = in_flight_;
+                    try {
+                        reap(in_flight_);
+                    }
+                    catch (...) {}
+                    if (in_flight_ < before) {
+                        failures = 0;
+                    } else {
+                        ++failures;
+                    }
+                }
+
+                if (callbacks_) {
+                    try {
+                        callbacks_->wait();
+                    }
+                    catch (...) {}
+                }
+
+                #ifdef RS_CORE_IO_URING
+                    close_ring();
+                #endif
+
+            }
+
+            inline void AsyncIO::read(Fdio& io, void* ptr, std::size_t len, std::ptrdiff_t offset, callback call) {
+                enqueue({false, io.handle(), ptr, len, offset, std::move(call)});
+            }
+
+            inline std::size_t AsyncIO::submit() {
+                #ifdef RS_CORE_IO_URING
+                    if (backend_ == backend::io_uring) {
+                        return submit_ring();
+                    }
+                #endif
+                return submit_pool();
+            }
+
+            inline std::size_t AsyncIO::wait(std::size_t count) {
+                submit();
+                return reap(std::min(count, in_flight_));
+            }
+
+            inline void AsyncIO::wait_all() {
+                submit();
+                while (in_flight_ > 0) {
+                    reap(in_flight_);
+                }
+                if (callbacks_) {
+                    callbacks_->wait();
+                }
+            }
+
+            inline void AsyncIO::write(Fdio& io, const void* ptr, std::size_t len, std::ptrdiff_t offset, callback call) {
+                enqueue({true, io.handle(), const_cast<void*>(ptr), len, offset, std::move(call)});
+            }
+
+            inline void AsyncIO::enqueue(operation op) {
+
+                // If every slot is in use, make room by waiting for at least
+                // one operation to complete
+
+                if (free_slots_.empty()) {
+                    submit();
+                    reap(1);
+                }
+
+                auto slot = free_slots_.back();
+                free_slots_.pop_back();
+                slots_[slot] = std::move(op);
+                queue_.push_back(slot);
+
+            }
+
+            inline void AsyncIO::init(std::size_t entries, backend mode) {
+
+                entries = std::clamp(entries, 1uz, 4096uz);
+                slots_.resize(entries);
+                free_slots_.reserve(entries);
+
+                for (auto i = entries; i > 0; --i) {
+                    free_slots_.push_back(i - 1);
+                }
+
+                #ifdef RS_CORE_IO_URING
+                    if (mode != backend::thread_pool && open_ring(entries)) {
+                        backend_ = backend::io_uring;
+                        return;
+                    }
+                #endif
+
+                if (mode == backend::io_uring) {
+                    throw std::system_error(std::make_error_code(std::errc::function_not_supported), "io_uring");
+                }
+
+                backend_ = backend::thread_pool;
+
+                if (work_pool_ == nullptr) {
+                    own_pool_ = std::make_unique<ThreadPool>();
+                    work_pool_ = own_pool_.get();
+                }
+
+            }
+
+            inline std::size_t AsyncIO::reap(std::size_t min_count) {
+
+                // If collection fails part way, the completions already
+                // consumed from the ring are still in the batch, and must be
+                // finished here before the error is rethrown, or their slots
+                // would never be released
+
+                std::vector<completion> batch;
+                std::exception_ptr error;
+
+                try {
+                    #ifdef RS_CORE_IO_URING
+                        if (backend_ == backend::io_uring) {
+                            collect_ring(batch, min_count);
+                        } else {
+                            collect_pool(batch, min_count);
+                        }
+                    #else
+                        collect_pool(batch, min_count);
+                    #endif
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+
+                // Free every slot before running any callbacks. Every
+                // callback is run even if one throws; the first exception
+                // is rethrown afterwards.
+
+                std::vector<std::pair<callback, result>> calls;
+                calls.reserve(batch.size());
+
+                for (auto& c: batch) {
+                    calls.emplace_back(std::move(slots_[c.slot].call), c.res);
+                    release_slot(c);
+                }
+
+                for (auto& [call, res]: calls) {
+                    try {
+                        if (! call) {
+                            continue;
+                        } else if (callbacks_) {
+                            callbacks_->insert([call = std::move(call), res] { call(res); });
+                        } else {
+                            call(res);
+                        }
+                    }
+                    catch (...) {
+                        if (! error) {
+                            error = std::current_exception();
+                        }
+                    }
+                }
+
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+
+                return batch.size();
+
+            }
+
+            inline void AsyncIO::release_slot(completion& c) {
+                slots_[c.slot] = {};
+                free_slots_.push_back(c.slot);
+                --in_flight_;
+            }
+
+            inline std::size_t AsyncIO::submit_pool() {
+
+                auto n = queue_.size();
+
+                for (; ! queue_.empty(); queue_.pop_front()) {
+                    auto slot = queue_.front();
+                    auto op = slots_[slot];
+                    op.call = {};
+                    ++in_flight_;
+                    work_pool_->insert([this, slot, op] {
+                        auto res = perform(op);
+                        std::unique_lock lock{mutex_};
+                        done_.push_back({slot, res});
+                        cv_.notify_all();
+                    });
+                }
+
+                return n;
+
+            }
+
+            inline std::size_t AsyncIO::collect_pool(std::vector<completion>& out, std::size_t min_count) {
+                std::unique_lock lock{mutex_};
+                cv_.wait(lock, [this, min_count] { return done_.size() >= min_count; });
+                out.swap(done_);
+                return out.size();
+            }
+
+            inline AsyncIO::result AsyncIO::perform(const operation& op) noexcept {
+
+                ::ssize_t rc;
+
+                do {
+                    if (op.writing) {
+                        rc = ::pwrite(op.fd, op.ptr, op.len, static_cast<::off_t>(op.offset));
+                    } else {
+                        rc = ::pread(op.fd, op.ptr, op.len, static_cast<::off_t>(op.offset));
+                    }
+                } while (rc == -1 && errno == EINTR);
+
+                if (rc == -1) {
+                    return {0, std::error_code(errno, std::system_category())};
+                } else {
+                    return {static_cast<std::size_t>(rc), {}};
+                }
+
+            }
+
+            #ifdef RS_CORE_IO_URING
+
+                inline bool AsyncIO::open_ring(std::size_t entries) noexcept {
+
+                    ::io_uring_params params {};
+                    auto fd = static_cast<int>(::syscall(__NR_io_uring_setup, static_cast<unsigned>(entries), &params));
+
+                    if (fd == -1) {
+                        return false;
+                    }
+
+                    ring_.fd = fd;
+
+                    // IORING_OP_READ and IORING_OP_WRITE arrived in Linux 5.6;
+                    // fast poll (5.7) is the oldest feature flag that implies
+                    // they are present
+
+                    if ((params.features & IORING_FEAT_FAST_POLL) == 0 || (params.features & IORING_FEAT_SINGLE_MMAP) == 0) {
+                        close_ring();
+                        return false;
+                    }
+
+                    // With a single mapping, the completion queue shares the
+                    // submission queue's mapping
+
+                    auto sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                    auto cq_size = params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+                    ring_.sq_map_size = std::max(sq_size, cq_size);
+                    ring_.sq_map = ::mmap(nullptr, ring_.sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+
+                    if (ring_.sq_map == MAP_FAILED) {
+                        ring_.sq_map = nullptr;
+                        close_ring();
+                        return false;
+                    }
+
+                    ring_.sqes_size = params.sq_entries * sizeof(::io_uring_sqe);
+                    auto sqes = ::mmap(nullptr, ring_.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+                    if (sqes == MAP_FAILED) {
+                        close_ring();
+                        return false;
+                    }
+
+                    auto sq = static_cast<char*>(ring_.sq_map);
+                    ring_.sqes = static_cast<::io_uring_sqe*>(sqes);
+                    ring_.sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+                    ring_.sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                    ring_.sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+                    ring_.sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                    ring_.sq_entries = params.sq_entries;
+                    ring_.cq_head = reinterpret_cast<unsigned*>(sq + params.cq_off.head);
+                    ring_.cq_tail = reinterpret_cast<unsigned*>(sq + params.cq_off.tail);
+                    ring_.cqes = reinterpret_cast<::io_uring_cqe*>(sq + params.cq_off.cqes);
+                    ring_.cq_mask = *reinterpret_cast<unsigned*>(sq + params.cq_off.ring_mask);
+
+                    return true;
+
+                }
+
+                inline void AsyncIO::close_ring() noexcept {
+                    if (ring_.sqes != nullptr) {
+                        ::munmap(ring_.sqes, ring_.sqes_size);
+                    }
+                    if (ring_.sq_map != nullptr) {
+                        ::munmap(ring_.sq_map, ring_.sq_map_size);
+                    }
+                    if (ring_.fd != -1) {
+                        ::close(ring_.fd);
+                    }
+                    ring_ = {};
+                }
+
+                inline int AsyncIO::enter(unsigned to_submit, unsigned min_complete, unsigned flags) noexcept {
+                    long rc;
+                    do {
+                        rc = ::syscall(__NR_io_uring_enter, ring_.fd, to_submit, min_complete, flags, nullptr, 0);
+                    } while (rc == -1 && errno == EINTR);
+                    return rc == -1 ? -1 : static_cast<int>(rc);
+                }
+
+                inline std::size_t AsyncIO::submit_ring() {
+
+                    // The number of slots never exceeds the ring size, so
+                    // everything queued always fits in the submission queue,
+                    // and the completion queue (twice the size) cannot overflow
+
+                    if (queue_.empty()) {
+                        return 0;
+                    }
+
+                    auto tail = *ring_.sq_tail;
+                    auto count = 0u;
+
+                    for (; ! queue_.empty(); queue_.pop_front()) {
+
+                        static constexpr auto max_len = 0x7fff'f000uz;
+
+                        auto slot = queue_.front();
+                        auto& op = slots_[slot];
+                        auto index = tail & ring_.sq_mask;
+                        auto& sqe = ring_.sqes[index];
+
+                        std::memset(&sqe, 0, sizeof(sqe));
+                        sqe.opcode = op.writing ? IORING_OP_WRITE : IORING_OP_READ;
+                        sqe.fd = op.fd;
+                        sqe.addr = reinterpret_cast<std::uintptr_t>(op.ptr);
+                        sqe.len = static_cast<std::uint32_t>(std::min(op.len, max_len));
+                        sqe.off = static_cast<std::uint64_t>(op.offset);
+                        sqe.user_data = slot;
+                        ring_.sq_array[index] = index;
+
+                        ++tail;
+                        ++count;
+                        ++in_flight_;
+
+                    }
+
+                    std::atomic_ref<unsigned>{*ring_.sq_tail}.store(tail, std::memory_order::release);
+                    ring_.unsubmitted += count;
+
+                    // If this fails, the entries not yet consumed by the
+                    // kernel will be passed again on the next call
+
+                    while (ring_.unsubmitted > 0) {
+                        auto rc = enter(ring_.unsubmitted, 0, 0);
+                        if (rc == -1) {
+                            throw std::system_error(std::error_code(errno, std::system_category()), "io_uring_enter");
+                        }
+                        ring_.unsubmitted -= static_cast<unsigned>(rc);
+                    }
+
+                    return count;
+
+                }
+
+                inline std::size_t AsyncIO::collect_ring(std::vector<completion>& out, std::size_t min_count) {
+
+                    for (;;) {
+
+                        auto head = *ring_.cq_head;
+                        auto tail = std::atomic_ref<unsigned>{*ring_.cq_tail}.load(std::memory_order::acquire);
+
+                        for (; head != tail; ++head) {
+                            auto& cqe = ring_.cqes[head & ring_.cq_mask];
+                            completion c {static_cast<std::size_t>(cqe.user_data), {}};
+                            if (cqe.res < 0) {
+                                c.res.error = std::error_code(- cqe.res, std::system_category());
+                            } else {
+                                c.res.bytes = static_cast<std::size_t>(cqe.res);
+                            }
+                            out.push_back(c);
+                        }
+
+                        std::atomic_ref<unsigned>{*ring_.cq_head}.store(head, std::memory_order::release);
+
+                        if (out.size() >= min_count) {
+                            return out.size();
+                        }
+
+                        auto wanted = static_cast<unsigned>(min_count - out.size());
+
+                        auto rc = enter(ring_.unsubmitted, wanted, IORING_ENTER_GETEVENTS);
+
+                        if (rc == -1) {
+                            throw std::system_error(std::error_code(errno, std::system_category()), "io_uring_enter");
+                        }
+
+                        ring_.unsubmitted -= static_cast<unsigned>(rc);
+
+                    }
+
+                }
+
+            #endif
+
+    #endif
+
+}
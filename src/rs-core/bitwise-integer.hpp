@@ -4,6 +4,7 @@
 #include "rs-core/format.hpp"
 #include "rs-core/global.hpp"
 #include "rs-core/hash.hpp"
+#include "rs-core/mp-integer.hpp"
 #include <algorithm>
 #include <array>
 #include <bit>
@@ -294,10 +295,14 @@ namespace RS {
 
         static_assert(N >= 1);
 
-        using word_type = std::uint32_t;
+        // Same word size as Natural (see mp-integer.hpp)
+
+        using word_type = Detail::MpWord;
 
     private:
 
+        using double_word_type = Detail::MpDoubleWord;
+
         static constexpr std::size_t word_size = 8 * sizeof(word_type);
         static constexpr std::size_t word_count = (N + word_size - 1) / word_size;
         static constexpr std::size_t final_bits = N % word_size ? N % word_size : word_size;
@@ -473,12 +478,12 @@ namespace RS {
 
         template <std::size_t N>
         constexpr LargeUint<N>::LargeUint(std::initializer_list<std::uint64_t> init) noexcept {
+            constexpr auto words_per_item = sizeof(std::uint64_t) / sizeof(word_type);
             auto ptr = init.begin();
             auto len = init.size();
-            for (auto i = len - 1uz, j = 0uz; i != npos && j < word_count; --i, j += 2) {
-                array_[j] = static_cast<word_type>(ptr[i]);
-                if (j + 1 < word_count) {
-                    array_[j + 1] = static_cast<word_type>(ptr[i] >> word_size);
+            for (auto i = len - 1uz, j = 0uz; i != npos && j < word_count; --i, j += words_per_item) {
+                for (auto k = 0uz; k < words_per_item && j + k < word_count; ++k) {
+                    array_[j + k] = static_cast<word_type>(ptr[i] >> (k * word_size));
                 }
             }
             do_mask();
@@ -506,15 +511,22 @@ namespace RS {
         template <std::size_t N>
         template <Arithmetic T>
         constexpr LargeUint<N>::operator T() const noexcept {
-            using L = std::numeric_limits<T>;
-            using U = std::conditional_t<! L::is_integer, T,
-                std::conditional_t<L::is_signed, std::int64_t, std::uint64_t>>;
-            constexpr auto word_factor = static_cast<U>(1ull << word_size);
-            U result = 0;
-            for (auto i = word_count - 1; i != npos; --i) {
-                result = result * word_factor + array_[i];
+            if constexpr (std::numeric_limits<T>::is_integer) {
+                constexpr auto max_words = std::min(word_count, 64 / word_size);
+                std::uint64_t result = 0;
+                for (auto i = 0uz; i < max_words; ++i) {
+                    result |= static_cast<std::uint64_t>(array_[i]) << (i * word_size);
+                }
+                return static_cast<T>(result);
+            } else {
+                constexpr auto half_factor = static_cast<T>(1ull << (word_size / 2));
+                constexpr auto word_factor = half_factor * half_factor;
+                T result = 0;
+                for (auto i = word_count - 1; i != npos; --i) {
+                    result = result * word_factor + static_cast<T>(array_[i]);
+                }
+                return result;
             }
-            return static_cast<T>(result);
         }
 
         template <std::size_t N>
@@ -582,7 +594,7 @@ namespace RS {
             for (auto i = 0uz; i < word_count; ++i) {
                 for (auto j = 0uz; j < word_count - i; ++j) {
                     auto k = i + j;
-                    auto p = static_cast<std::uint64_t>(array_[i]) * static_cast<std::uint64_t>(y.array_[j]);
+                    auto p = static_cast<double_word_type>(array_[i]) * static_cast<double_word_type>(y.array_[j]);
                     word_type carry = 0;
                     add_with_carry(z.array_[k], word_type(p), carry);
                     if (++k < word_count) {
@@ -1,11 +1,19 @@
 #pragma once
 
 #include "rs-core/global.hpp"
+#include "rs-core/io.hpp"
+#include "rs-core/parallel.hpp"
+#include "rs-core/scope.hpp"
+#include "rs-core/thread-pool.hpp"
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <format>
+#include <functional>
 #include <iterator>
 #include <new>
 #include <ranges>
@@ -13,10 +21,47 @@
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 #include <zlib.h>
 
 namespace RS {
 
+    namespace Detail {
+
+        // Avoid zero filling space that a codec is about to overwrite, if
+        // the buffer type allows it. Return the requested size from the
+        // callback, because some implementations pass in the capacity.
+
+        template <OutputBuffer OB>
+        void resize_output(OB& out, std::size_t n) {
+
+            using Byte = std::ranges::range_value_t<OB>;
+
+            if constexpr (requires { out.resize_and_overwrite(n, [n] (Byte*, std::size_t) { return n; }); }) {
+                out.resize_and_overwrite(n, [n] (Byte*, std::size_t) { return n; });
+            } else {
+                out.resize(n, Byte{});
+            }
+
+        }
+
+    }
+
+    // Codec concept
+
+    struct CodecResult {
+        std::size_t bytes_in;
+        std::size_t bytes_out;
+    };
+
+    template <typename T>
+    concept Codec = requires (T& t, const std::string_view& in, std::string& out) {
+        { t.encode(in, out) } -> std::convertible_to<CodecResult>;
+        { t.decode(in, out) } -> std::convertible_to<CodecResult>;
+    };
+
+    // Zlib codec
+
     class Zlib {
 
     public:
@@ -31,10 +76,9 @@ namespace RS {
             static std::string expand_error(int code, std::string_view details);
         };
 
-        struct result {
-            std::size_t bytes_in;
-            std::size_t bytes_out;
-        };
+        using result = CodecResult;
+
+        static constexpr std::size_t default_block_size = 128 * 1024;
 
         Zlib() = default;
         explicit Zlib(int level) { set_level(level); }
@@ -46,19 +90,41 @@ namespace RS {
             result encode(const IS& in, OB& out) const;
         template <InputSpan IS, OutputBuffer OB>
             result encode(const IS& in, OB& out, int level) const;
+        template <InputSpan IS, OutputBuffer OB>
+            result encode(const IS& in, OB& out, ThreadPool& pool,
+                std::size_t block_size = default_block_size) const;
+        template <InputSpan IS, OutputBuffer OB>
+            result encode(const IS& in, OB& out, int level, ThreadPool& pool,
+                std::size_t block_size = default_block_size) const;
         template <InputSpan IS, OutputBuffer OB>
             result decode(const IS& in, OB& out) const;
+        template <InputSpan IS, OutputBuffer OB>
+            result decode(const IS& in, OB& out, std::size_t size_hint) const;
 
     private:
 
+        friend class ZlibContext;
+        friend class ZlibStream;
+
+        // Without a hint, start decoding by assuming a typical compression
+        // ratio
+
+        static constexpr std::size_t guess_factor = 4;
+
         int level_ = -1;
 
-        template <InputSpan IS, OutputBuffer OB, std::invocable<z_streamp> Init,
+        template <InputSpan IS, OutputBuffer OB, std::invocable<z_streamp> Init, std::invocable<z_streamp> Bound,
             std::invocable<z_streamp, int> Call, std::invocable<z_streamp> End>
-        result encode_or_decode(const IS& in, OB& out, Init zlib_init, Call zlib_call, End zlib_end,
-            bool encoding) const;
+        result encode_or_decode(const IS& in, OB& out, Init zlib_init, Bound zlib_bound, Call zlib_call,
+            End zlib_end, bool encoding) const;
+        template <InputSpan IS, OutputBuffer OB, std::invocable<z_streamp, int> Call>
+        static result run_stream(z_stream& zs, const IS& in, OB& out, std::size_t initial_size, Call zlib_call,
+            bool encoding);
 
         static int check_result(int rc);
+        static void check_level(int level);
+        static std::vector<unsigned char> deflate_block(const unsigned char* ptr, std::size_t len,
+            std::size_t dict_len, int level, bool last);
 
     };
 
@@ -100,11 +166,8 @@ namespace RS {
         }
 
         inline void Zlib::set_level(int level) {
-            if (level >= -1 && level <= 9) {
-                level_ = level;
-            } else {
-                throw error(Z_STREAM_ERROR, "Invalid compression level");
-            }
+            check_level(level);
+            level_ = level;
         }
 
         template <InputSpan IS, OutputBuffer OB>
@@ -114,54 +177,150 @@ namespace RS {
 
         template <InputSpan IS, OutputBuffer OB>
         Zlib::result Zlib::encode(const IS& in, OB& out, int level) const {
+            auto size = static_cast<uLong>(std::ranges::size(in));
             return encode_or_decode(in, out,
                 [level] (z_streamp zsp) { return deflateInit(zsp, level); },
+                [size] (z_streamp zsp) { return static_cast<std::size_t>(deflateBound(zsp, size)); },
                 [] (z_streamp zsp, int flush) { return deflate(zsp, flush); },
                 [] (z_streamp zsp) { return deflateEnd(zsp); },
                 true);
         }
 
+        template <InputSpan IS, OutputBuffer OB>
+        Zlib::result Zlib::encode(const IS& in, OB& out, ThreadPool& pool, std::size_t block_size) const {
+            return encode(in, out, level_, pool, block_size);
+        }
+
+        template <InputSpan IS, OutputBuffer OB>
+        Zlib::result Zlib::encode(const IS& in, OB& out, int level, ThreadPool& pool,
+                std::size_t block_size) const {
+
+            // Each block is compressed independently as raw deflate data,
+            // primed with the preceding 32k of input as a dictionary. All
+            // blocks except the last end with a sync flush, which leaves
+            // them byte aligned and not marked final, so they can simply be
+            // concatenated. The Adler-32 checksums are combined afterwards.
+
+            namespace rs = std::ranges;
+
+            static constexpr auto max_dictionary = 32uz * 1024;
+
+            check_level(level);
+            auto size = rs::size(in);
+            block_size = std::clamp(block_size, max_dictionary, 1uz << 30);
+
+            if (size <= block_size) {
+                return encode(in, out, level);
+            }
+
+            auto in_ptr = reinterpret_cast<const unsigned char*>(&*rs::begin(in));
+            auto blocks = (size + block_size - 1) / block_size;
+            std::vector<std::vector<unsigned char>> packed(blocks);
+            std::vector<uLong> checks(blocks);
+
+            parallel_for(pool, 0uz, blocks, [&] (std::size_t i) {
+                auto offset = i * block_size;
+                auto len = std::min(block_size, size - offset);
+                auto dict_len = std::min(offset, max_dictionary);
+                packed[i] = deflate_block(in_ptr + offset, len, dict_len, level, i + 1 == blocks);
+                checks[i] = adler32(adler32(0, nullptr, 0), in_ptr + offset, static_cast<uInt>(len));
+            }, 1);
+
+            auto check = checks[0];
+
+            for (auto i = 1uz; i < blocks; ++i) {
+                auto len = std::min(block_size, size - i * block_size);
+                check = adler32_combine(check, checks[i], static_cast<z_off_t>(len));
+            }
+
+            // Zlib header: deflate with a 32k window, the level hint, and
+            // check bits making the header a multiple of 31
+
+            if (level == -1) {
+                level = 6;
+            }
+
+            auto level_flag = level < 2 ? 0u : level < 6 ? 1u : level == 6 ? 2u : 3u;
+            auto header = 0x7800u | (level_flag << 6);
+            header += 31 - header % 31;
+
+            auto total = 6uz;
+
+            for (auto& p: packed) {
+                total += p.size();
+            }
+
+            auto out_offset = out.size();
+            Detail::resize_output(out, out_offset + total);
+            auto out_ptr = reinterpret_cast<unsigned char*>(&*rs::begin(out)) + out_offset;
+            *out_ptr++ = static_cast<unsigned char>(header >> 8);
+            *out_ptr++ = static_cast<unsigned char>(header & 0xff);
+
+            for (auto& p: packed) {
+                std::memcpy(out_ptr, p.data(), p.size());
+                out_ptr += p.size();
+            }
+
+            for (auto shift = 24; shift >= 0; shift -= 8) {
+                *out_ptr++ = static_cast<unsigned char>((check >> shift) & 0xff);
+            }
+
+            return {size, total};
+
+        }
+
         template <InputSpan IS, OutputBuffer OB>
         Zlib::result Zlib::decode(const IS& in, OB& out) const {
+            return decode(in, out, guess_factor * std::ranges::size(in));
+        }
+
+        template <InputSpan IS, OutputBuffer OB>
+        Zlib::result Zlib::decode(const IS& in, OB& out, std::size_t size_hint) const {
             return encode_or_decode(in, out,
                 [] (z_streamp zsp) { return inflateInit(zsp); },
+                [size_hint] (z_streamp) { return size_hint; },
                 [] (z_streamp zsp, int flush) { return inflate(zsp, flush); },
                 [] (z_streamp zsp) { return inflateEnd(zsp); },
                 false);
         }
 
-        template <InputSpan IS, OutputBuffer OB, std::invocable<z_streamp> Init,
+        template <InputSpan IS, OutputBuffer OB, std::invocable<z_streamp> Init, std::invocable<z_streamp> Bound,
             std::invocable<z_streamp, int> Call, std::invocable<z_streamp> End>
-        Zlib::result Zlib::encode_or_decode(const IS& in, OB& out, Init zlib_init, Call zlib_call, End zlib_end,
-                bool encoding) const {
+        Zlib::result Zlib::encode_or_decode(const IS& in, OB& out, Init zlib_init, Bound zlib_bound, Call zlib_call,
+                End zlib_end, bool encoding) const {
 
             // Call this with lambdas instead of raw Zlib functions to guard
             // against macros in Zlib.
 
+            z_stream zs;
+            std::memset(&zs, 0, sizeof(zs));
+            check_result(zlib_init(&zs));
+            auto guard = on_exit([&zs, &zlib_end] { zlib_end(&zs); });
+
+            return run_stream(zs, in, out, static_cast<std::size_t>(zlib_bound(&zs)), zlib_call, encoding);
+
+        }
+
+        template <InputSpan IS, OutputBuffer OB, std::invocable<z_streamp, int> Call>
+        Zlib::result Zlib::run_stream(z_stream& zs, const IS& in, OB& out, std::size_t initial_size,
+                Call zlib_call, bool encoding) {
+
+            // The output buffer is initially sized from deflateBound() when
+            // encoding, or the size hint when decoding. When encoding this
+            // is always enough; otherwise the buffer grows geometrically.
+
             namespace rs = std::ranges;
             using Byte = rs::range_value_t<OB>;
 
             static constexpr auto min_io_block = 16uz;
-            static constexpr auto max_io_block = 1uz << 20;
-            static constexpr auto guess_factor = 4uz;
+            static constexpr auto max_io_block = 1uz << 30;
 
-            z_stream zs;
-            std::memset(&zs, 0, sizeof(zs));
-            check_result(zlib_init(&zs));
             auto flush = Z_NO_FLUSH;
-            auto guess_out_block = rs::size(in);
-
-            if (encoding) {
-                guess_out_block /= guess_factor;
-            } else {
-                guess_out_block *= guess_factor;
-            }
-
-            auto out_block = std::clamp(guess_out_block, min_io_block, max_io_block);
             auto in_offset = 0uz;
             auto out_offset = out.size();
             auto initial_out_offset = out_offset;
-            out.resize(out_offset + out_block, Byte{});
+            auto guard = guard_size(out);
+            Detail::resize_output(out, out_offset + std::max(initial_size, min_io_block));
 
             for (;;) {
 
@@ -170,7 +329,7 @@ namespace RS {
                 auto in_available = std::min(in_remaining, max_io_block);
                 auto out_ptr = &*rs::begin(out) + out_offset;
                 auto out_remaining = rs::size(out) - out_offset;
-                auto out_available = std::min(out_remaining, out_block);
+                auto out_available = std::min(out_remaining, max_io_block);
 
                 zs.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(in_ptr)); // Zlib brain damage
                 zs.avail_in = static_cast<uInt>(in_available);
@@ -184,16 +343,18 @@ namespace RS {
 
                 if (rc == Z_STREAM_END) {
                     break;
-                } else if (rc == Z_BUF_ERROR) {
-                    out.resize(out_offset + out_block, Byte{});
+                } else if (out_offset == rs::size(out)) {
+                    auto grow = std::max(out_offset - initial_out_offset, min_io_block);
+                    Detail::resize_output(out, out_offset + grow);
                 } else if (encoding && in_offset == rs::size(in)) {
                     flush = Z_FINISH;
+                } else if (rc == Z_BUF_ERROR) {
+                    throw error(Z_DATA_ERROR, "Compressed data is incomplete");
                 }
 
             }
 
             out.resize(out_offset, Byte{});
-            check_result(zlib_end(&zs));
 
             return {in_offset, out_offset - initial_out_offset};
 
@@ -209,4 +370,723 @@ namespace RS {
             }
         }
 
+        inline void Zlib::check_level(int level) {
+            if (level < -1 || level > 9) {
+                throw error(Z_STREAM_ERROR, "Invalid compression level");
+            }
+        }
+
+        inline std::vector<unsigned char> Zlib::deflate_block(const unsigned char* ptr, std::size_t len,
+                std::size_t dict_len, int level, bool last) {
+
+            // The dictionary is the dict_len bytes immediately before ptr
+
+            static constexpr int raw_deflate = -15;
+            static constexpr int default_mem_level = 8;
+
+            z_stream zs;
+            std::memset(&zs, 0, sizeof(zs));
+            check_result(deflateInit2(&zs, level, Z_DEFLATED, raw_deflate, default_mem_level, Z_DEFAULT_STRATEGY));
+            auto guard = on_exit([&zs] { deflateEnd(&zs); });
+
+            if (dict_len != 0) {
+                check_result(deflateSetDictionary(&zs, ptr - dict_len, static_cast<uInt>(dict_len)));
+            }
+
+            // The bound does not allow for the sync flush marker
+
+            std::vector<unsigned char> out(deflateBound(&zs, static_cast<uLong>(len)) + 16);
+            auto flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+            auto out_offset = 0uz;
+            zs.next_in = const_cast<Bytef*>(ptr); // Zlib brain damage
+            zs.avail_in = static_cast<uInt>(len);
+
+            for (;;) {
+
+                auto out_available = out.size() - out_offset;
+                zs.next_out = out.data() + out_offset;
+                zs.avail_out = static_cast<uInt>(out_available);
+                auto rc = check_result(deflate(&zs, flush));
+                out_offset += out_available - zs.avail_out;
+
+                if (rc == Z_STREAM_END || (! last && zs.avail_out != 0)) {
+                    break;
+                }
+
+                out.resize(2 * out.size());
+
+            }
+
+            out.resize(out_offset);
+
+            return out;
+
+        }
+
+    class ZlibContext {
+
+    public:
+
+        using result = CodecResult;
+
+        static constexpr std::size_t max_dictionary = 32 * 1024;
+
+        ZlibContext(): ZlibContext(-1) {}
+        explicit ZlibContext(int level, std::string_view dictionary = {});
+        ~ZlibContext() noexcept;
+
+        ZlibContext(const ZlibContext&) = delete;
+        ZlibContext(ZlibContext&&) = delete;
+        ZlibContext& operator=(const ZlibContext&) = delete;
+        ZlibContext& operator=(ZlibContext&&) = delete;
+
+        int level() const noexcept { return level_; }
+        std::string_view dictionary() const noexcept { return dictionary_; }
+
+        template <InputSpan IS, OutputBuffer OB> result encode(const IS& in, OB& out);
+        template <InputSpan IS, OutputBuffer OB> result decode(const IS& in, OB& out);
+        template <InputSpan IS, OutputBuffer OB> result decode(const IS& in, OB& out, std::size_t size_hint);
+
+    private:
+
+        // The Zlib streams are initialized on first use and reset after
+        // that, since initialization allocates the Zlib state
+
+        z_stream encoder_;
+        z_stream decoder_;
+        bool encoder_ready_ = false;
+        bool decoder_ready_ = false;
+        int level_ = -1;
+        std::string dictionary_;
+
+        void start_encoder();
+        void start_decoder();
+        int inflate_with_dictionary(z_streamp zsp, int flush);
+
+    };
+
+        inline ZlibContext::ZlibContext(int level, std::string_view dictionary):
+        level_{level},
+        dictionary_{dictionary.substr(dictionary.size() - std::min(dictionary.size(), max_dictionary))} {
+            Zlib::check_level(level);
+            std::memset(&encoder_, 0, sizeof(encoder_));
+            std::memset(&decoder_, 0, sizeof(decoder_));
+        }
+
+        inline ZlibContext::~ZlibContext() noexcept {
+            if (encoder_ready_) {
+                deflateEnd(&encoder_);
+            }
+            if (decoder_ready_) {
+                inflateEnd(&decoder_);
+            }
+        }
+
+        template <InputSpan IS, OutputBuffer OB>
+        ZlibContext::result ZlibContext::encode(const IS& in, OB& out) {
+            start_encoder();
+            auto bound = deflateBound(&encoder_, static_cast<uLong>(std::ranges::size(in)));
+            return Zlib::run_stream(encoder_, in, out, static_cast<std::size_t>(bound),
+                [] (z_streamp zsp, int flush) { return deflate(zsp, flush); },
+                true);
+        }
+
+        template <InputSpan IS, OutputBuffer OB>
+        ZlibContext::result ZlibContext::decode(const IS& in, OB& out) {
+            return decode(in, out, Zlib::guess_factor * std::ranges::size(in));
+        }
+
+        template <InputSpan IS, OutputBuffer OB>
+        ZlibContext::result ZlibContext::decode(const IS& in, OB& out, std::size_t size_hint) {
+            start_decoder();
+            return Zlib::run_stream(decoder_, in, out, size_hint,
+                [this] (z_streamp zsp, int flush) { return inflate_with_dictionary(zsp, flush); },
+                false);
+        }
+
+        inline void ZlibContext::start_encoder() {
+
+            // deflateReset() also discards the dictionary, so it needs to
+            // be set again for every stream
+
+            if (encoder_ready_) {
+                Zlib::check_result(deflateReset(&encoder_));
+            } else {
+                Zlib::check_result(deflateInit(&encoder_, level_));
+                encoder_ready_ = true;
+            }
+
+            if (! dictionary_.empty()) {
+                Zlib::check_result(deflateSetDictionary(&encoder_,
+                    reinterpret_cast<const Bytef*>(dictionary_.data()),
+                    static_cast<uInt>(dictionary_.size())));
+            }
+
+        }
+
+        inline void ZlibContext::start_decoder() {
+            if (decoder_ready_) {
+                Zlib::check_result(inflateReset(&decoder_));
+            } else {
+                Zlib::check_result(inflateInit(&decoder_));
+                decoder_ready_ = true;
+            }
+        }
+
+        inline int ZlibContext::inflate_with_dictionary(z_streamp zsp, int flush) {
+
+            // Inflate stops after reading the header of a stream that was
+            // compressed with a dictionary, and waits for it to be supplied
+
+            auto rc = inflate(zsp, flush);
+
+            if (rc == Z_NEED_DICT && ! dictionary_.empty()) {
+                rc = inflateSetDictionary(zsp, reinterpret_cast<const Bytef*>(dictionary_.data()),
+                    static_cast<uInt>(dictionary_.size()));
+                if (rc == Z_DATA_ERROR) {
+                    throw Zlib::error(rc, "Preset dictionary does not match");
+                }
+                Zlib::check_result(rc);
+                rc = inflate(zsp, flush);
+            }
+
+            return rc;
+
+        }
+
+    class ZlibStream {
+
+    public:
+
+        enum class mode: int {
+            encode,
+            decode,
+        };
+
+        using enum mode;
+        using sink_type = std::function<void(std::string_view)>;
+
+        static constexpr std::size_t default_buffer_size = 64 * 1024;
+
+        ZlibStream(mode m, sink_type sink, int level = -1, std::size_t buffer_size = default_buffer_size);
+        ZlibStream(mode m, IO& out, int level = -1, std::size_t buffer_size = default_buffer_size);
+        ~ZlibStream() noexcept;
+
+        ZlibStream(const ZlibStream&) = delete;
+        ZlibStream(ZlibStream&&) = delete;
+        ZlibStream& operator=(const ZlibStream&) = delete;
+        ZlibStream& operator=(ZlibStream&&) = delete;
+
+        template <InputSpan IS> std::size_t write(const IS& in);
+        void flush();
+        void finish();
+        bool done() const noexcept { return done_; }
+        std::uint64_t bytes_in() const noexcept { return bytes_in_; }
+        std::uint64_t bytes_out() const noexcept { return bytes_out_; }
+
+    private:
+
+        // Zlib counts bytes in a uInt, so long inputs are fed to it in pieces
+
+        static constexpr std::size_t max_chunk = 1uz << 30;
+
+        z_stream zs_;
+        mode mode_;
+        sink_type sink_;
+        std::vector<char> buffer_;
+        std::uint64_t bytes_in_ = 0;
+        std::uint64_t bytes_out_ = 0;
+        bool done_ = false;
+
+        void emit();
+        std::size_t process(const void* ptr, std::size_t len, int flush);
+
+    };
+
+        inline ZlibStream::ZlibStream(mode m, sink_type sink, int level, std::size_t buffer_size):
+        mode_{m},
+        sink_{std::move(sink)},
+        buffer_(std::clamp(buffer_size, 64uz, max_chunk)) {
+
+            Zlib::check_level(level);
+            std::memset(&zs_, 0, sizeof(zs_));
+
+            if (mode_ == encode) {
+                Zlib::check_result(deflateInit(&zs_, level));
+            } else {
+                Zlib::check_result(inflateInit(&zs_));
+            }
+
+            zs_.next_out = reinterpret_cast<Bytef*>(buffer_.data());
+            zs_.avail_out = static_cast<uInt>(buffer_.size());
+
+        }
+
+        inline ZlibStream::ZlibStream(mode m, IO& out, int level, std::size_t buffer_size):
+        ZlibStream{m, [&out] (std::string_view block) { out.write(block.data(), block.size()); }, level, buffer_size} {}
+
+        inline ZlibStream::~ZlibStream() noexcept {
+            if (mode_ == encode) {
+                deflateEnd(&zs_);
+            } else {
+                inflateEnd(&zs_);
+            }
+        }
+
+        template <InputSpan IS>
+        std::size_t ZlibStream::write(const IS& in) {
+
+            if (done_) {
+                if (mode_ == mode::encode) {
+                    throw Zlib::error(Z_STREAM_ERROR, "Stream is already finished");
+                }
+                return 0;
+            }
+
+            auto size = std::ranges::size(in);
+
+            if (size == 0) {
+                return 0;
+            }
+
+            return process(&*std::ranges::begin(in), size, Z_NO_FLUSH);
+
+        }
+
+        inline void ZlibStream::flush() {
+            if (mode_ == encode && ! done_) {
+                process(nullptr, 0, Z_SYNC_FLUSH);
+            }
+            emit();
+        }
+
+        inline void ZlibStream::finish() {
+            if (mode_ == encode) {
+                if (! done_) {
+                    process(nullptr, 0, Z_FINISH);
+                }
+                emit();
+            } else {
+                emit();
+                if (! done_) {
+                    throw Zlib::error(Z_DATA_ERROR, "Compressed stream is incomplete");
+                }
+            }
+        }
+
+        inline void ZlibStream::emit() {
+            auto n = buffer_.size() - zs_.avail_out;
+            if (n != 0) {
+                sink_(std::string_view(buffer_.data(), n));
+                bytes_out_ += n;
+                zs_.next_out = reinterpret_cast<Bytef*>(buffer_.data());
+                zs_.avail_out = static_cast<uInt>(buffer_.size());
+            }
+        }
+
+        inline std::size_t ZlibStream::process(const void* ptr, std::size_t len, int flush) {
+
+            // Output is only passed to the sink when the buffer is full, or
+            // when flush() or finish() is called
+
+            auto byte_ptr = static_cast<const Bytef*>(ptr);
+            auto offset = 0uz;
+
+            do {
+
+                auto chunk = std::min(len - offset, max_chunk);
+                auto chunk_flush = offset + chunk == len ? flush : Z_NO_FLUSH;
+                zs_.next_in = const_cast<Bytef*>(byte_ptr + offset); // Zlib brain damage
+                zs_.avail_in = static_cast<uInt>(chunk);
+
+                do {
+
+                    if (zs_.avail_out == 0) {
+                        emit();
+                    }
+
+                    int rc;
+
+                    if (mode_ == encode) {
+                        rc = Zlib::check_result(deflate(&zs_, chunk_flush));
+                    } else {
+                        rc = Zlib::check_result(inflate(&zs_, chunk_flush));
+                    }
+
+                    if (rc == Z_STREAM_END) {
+                        done_ = true;
+                    } else if (rc == Z_BUF_ERROR && zs_.avail_out != 0) {
+                        break;
+                    }
+
+                } while (! done_ && (zs_.avail_in != 0 || zs_.avail_out == 0));
+
+                auto used = chunk - zs_.avail_in;
+                offset += used;
+                bytes_in_ += used;
+
+            } while (! done_ && offset < len);
+
+            zs_.next_in = nullptr;
+            zs_.avail_in = 0;
+
+            return offset;
+
+        }
+
+    // LZ4 codec
+
+    class Lz4 {
+
+    public:
+
+        class error:
+        public std::runtime_error {
+        public:
+            explicit error(std::string_view details):
+            std::runtime_error{"LZ4 error: " + std::string{details}} {}
+        };
+
+        using result = CodecResult;
+
+        template <InputSpan IS, OutputBuffer OB> result encode(const IS& in, OB& out) const;
+        template <InputSpan IS, OutputBuffer OB> result decode(const IS& in, OB& out) const;
+
+        static constexpr std::size_t max_encoded_size(std::size_t n) noexcept
+            { return max_header + n + n / 255 + 16; }
+
+    private:
+
+        static constexpr std::size_t max_header = 10;
+        static constexpr std::size_t min_match = 4;
+        static constexpr std::size_t last_literals = 5;
+        static constexpr std::size_t match_limit = 12;
+        static constexpr std::size_t max_offset = 65'535;
+        static constexpr int hash_bits = 12;
+        static constexpr int skip_trigger = 6;
+
+        static std::size_t encode_block(const unsigned char* src, std::size_t n, unsigned char* dst) noexcept;
+        static std::size_t decode_block(const unsigned char* src, std::size_t n, unsigned char* dst,
+            std::size_t size);
+        static std::uint32_t load32(const unsigned char* ptr) noexcept;
+        static std::size_t match_length(const unsigned char* p, const unsigned char* q,
+            const unsigned char* end) noexcept;
+        static unsigned char* write_length(unsigned char* dst, std::size_t len) noexcept;
+
+    };
+
+        template <InputSpan IS, OutputBuffer OB>
+        Lz4::result Lz4::encode(const IS& in, OB& out) const {
+
+            using Byte = std::ranges::range_value_t<OB>;
+
+            auto n = std::ranges::size(in);
+            auto src = reinterpret_cast<const unsigned char*>(std::ranges::data(in));
+            auto initial_out_offset = out.size();
+            Detail::resize_output(out, initial_out_offset + max_encoded_size(n));
+            auto dst = reinterpret_cast<unsigned char*>(&*std::ranges::begin(out)) + initial_out_offset;
+            auto bytes_out = encode_block(src, n, dst);
+            out.resize(initial_out_offset + bytes_out, Byte{});
+
+            return {n, bytes_out};
+
+        }
+
+        template <InputSpan IS, OutputBuffer OB>
+        Lz4::result Lz4::decode(const IS& in, OB& out) const {
+
+            using Byte = std::ranges::range_value_t<OB>;
+
+            auto n = std::ranges::size(in);
+            auto src = reinterpret_cast<const unsigned char*>(std::ranges::data(in));
+            auto size = 0uz;
+            auto pos = 0uz;
+
+            for (auto shift = 0uz;; shift += 7) {
+                if (pos == n) {
+                    throw error("Compressed data is incomplete");
+                } else if (shift >= 64) {
+                    throw error("Compressed data is corrupt");
+                }
+                auto byte = src[pos++];
+                size |= static_cast<std::size_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {
+                    break;
+                }
+            }
+
+            // No input byte can expand to more than 255 output bytes, so
+            // reject impossible sizes before allocating anything
+
+            if (size / 255 > n - pos) {
+                throw error("Compressed data is corrupt");
+            } else if (size == 0) {
+                return {pos, 0};
+            }
+
+            auto initial_out_offset = out.size();
+            Detail::resize_output(out, initial_out_offset + size);
+            auto dst = reinterpret_cast<unsigned char*>(&*std::ranges::begin(out)) + initial_out_offset;
+
+            try {
+                pos += decode_block(src + pos, n - pos, dst, size);
+            }
+            catch (...) {
+                out.resize(initial_out_offset, Byte{});
+                throw;
+            }
+
+            return {pos, size};
+
+        }
+
+        inline std::size_t Lz4::encode_block(const unsigned char* src, std::size_t n, unsigned char* dst) noexcept {
+
+            // The output is the uncompressed size as a LEB128 varint,
+            // followed by an LZ4 block
+
+            auto op = dst;
+            auto k = n;
+
+            for (; k >= 0x80; k >>= 7) {
+                *op++ = static_cast<unsigned char>(k | 0x80);
+            }
+
+            *op++ = static_cast<unsigned char>(k);
+
+            if (n == 0) {
+                return static_cast<std::size_t>(op - dst);
+            }
+
+            auto put_literals = [&op] (const unsigned char* ptr, std::size_t len) {
+                auto token = op++;
+                if (len >= 15) {
+                    *token = 0xf0;
+                    op = write_length(op, len - 15);
+                } else {
+                    *token = static_cast<unsigned char>(len << 4);
+                }
+                std::memcpy(op, ptr, len);
+                op += len;
+                return token;
+            };
+
+            auto anchor = 0uz;
+
+            if (n > match_limit) {
+
+                // Hash table entries hold the low 32 bits of a position, so
+                // the distance is calculated modulo 2^32. Stale or bogus
+                // entries are rejected by comparing the data.
+
+                std::array<std::uint32_t, 1uz << hash_bits> table {};
+
+                auto hash = [src] (std::size_t i) {
+                    return (load32(src + i) * 2'654'435'761u) >> (32 - hash_bits);
+                };
+
+                auto probe = [src, &table, &hash] (std::size_t i) {
+                    auto h = hash(i);
+                    std::size_t offset = static_cast<std::uint32_t>(i - table[h]);
+                    table[h] = static_cast<std::uint32_t>(i);
+                    if (offset == 0 || offset > max_offset || load32(src + i - offset) != load32(src + i)) {
+                        offset = 0;
+                    }
+                    return offset;
+                };
+
+                auto search_limit = n - match_limit;
+                auto extend_end = src + n - last_literals;
+                auto ip = 1uz;
+                table[hash(0)] = 0;
+
+                for (;;) {
+
+                    // Look for a match, stepping faster through data that
+                    // does not compress
+
+                    auto offset = 0uz;
+
+                    for (auto step = 1uz << skip_trigger; ip <= search_limit; ip += step++ >> skip_trigger) {
+                        offset = probe(ip);
+                        if (offset != 0) {
+                            break;
+                        }
+                    }
+
+                    if (offset == 0) {
+                        break;
+                    }
+
+                    while (ip > anchor && ip > offset && src[ip - 1] == src[ip - offset - 1]) {
+                        --ip;
+                    }
+
+                    auto token = put_literals(src + anchor, ip - anchor);
+
+                    // Emit the match, and any further matches that start
+                    // immediately after it
+
+                    for (;;) {
+
+                        *op++ = static_cast<unsigned char>(offset & 0xff);
+                        *op++ = static_cast<unsigned char>(offset >> 8);
+                        auto len = match_length(src + ip + min_match, src + ip + min_match - offset, extend_end);
+                        ip += min_match + len;
+
+                        if (len >= 15) {
+                            *token |= 0x0f;
+                            op = write_length(op, len - 15);
+                        } else {
+                            *token |= static_cast<unsigned char>(len);
+                        }
+
+                        anchor = ip;
+
+                        if (ip > search_limit) {
+                            break;
+                        }
+
+                        table[hash(ip - 2)] = static_cast<std::uint32_t>(ip - 2);
+                        offset = probe(ip);
+
+                        if (offset == 0) {
+                            break;
+                        }
+
+                        token = op++;
+                        *token = 0;
+
+                    }
+
+                    ++ip;
+
+                }
+
+            }
+
+            put_literals(src + anchor, n - anchor);
+
+            return static_cast<std::size_t>(op - dst);
+
+        }
+
+        inline std::size_t Lz4::decode_block(const unsigned char* src, std::size_t n, unsigned char* dst,
+                std::size_t size) {
+
+            auto ip = src;
+            auto in_end = src + n;
+            auto op = dst;
+            auto out_end = dst + size;
+
+            auto read_length = [&ip, in_end] (std::size_t len) {
+                if (len == 15) {
+                    unsigned char byte;
+                    do {
+                        if (ip == in_end) {
+                            throw error("Compressed data is incomplete");
+                        }
+                        byte = *ip++;
+                        len += byte;
+                    } while (byte == 255);
+                }
+                return len;
+            };
+
+            // A valid block always ends with a sequence of literals that
+            // exactly fills the output
+
+            for (;;) {
+
+                if (ip == in_end) {
+                    throw error("Compressed data is incomplete");
+                }
+
+                auto token = *ip++;
+                auto len = read_length(static_cast<std::size_t>(token >> 4));
+
+                if (len > static_cast<std::size_t>(in_end - ip)) {
+                    throw error("Compressed data is incomplete");
+                } else if (len > static_cast<std::size_t>(out_end - op)) {
+                    throw error("Compressed data is corrupt");
+                }
+
+                std::memcpy(op, ip, len);
+                ip += len;
+                op += len;
+
+                if (op == out_end) {
+                    break;
+                } else if (in_end - ip < 2) {
+                    throw error("Compressed data is incomplete");
+                }
+
+                auto offset = static_cast<std::size_t>(ip[0] | (ip[1] << 8));
+                ip += 2;
+
+                if (offset == 0 || offset > static_cast<std::size_t>(op - dst)) {
+                    throw error("Compressed data is corrupt");
+                }
+
+                len = read_length(static_cast<std::size_t>(token & 0x0f)) + min_match;
+
+                if (len > static_cast<std::size_t>(out_end - op)) {
+                    throw error("Compressed data is corrupt");
+                }
+
+                auto match = op - offset;
+
+                // If the match overlaps the output, the copied data repeats
+                // with a period of the offset, so copy it in chunks that
+                // double in size each time
+
+                while (len > 0) {
+                    auto chunk = std::min(static_cast<std::size_t>(op - match), len);
+                    std::memcpy(op, match, chunk);
+                    op += chunk;
+                    len -= chunk;
+                }
+
+            }
+
+            return static_cast<std::size_t>(ip - src);
+
+        }
+
+        inline std::uint32_t Lz4::load32(const unsigned char* ptr) noexcept {
+            std::uint32_t x;
+            std::memcpy(&x, ptr, sizeof(x));
+            return x;
+        }
+
+        inline std::size_t Lz4::match_length(const unsigned char* p, const unsigned char* q,
+                const unsigned char* end) noexcept {
+
+            auto start = p;
+
+            if constexpr (std::endian::native == std::endian::little) {
+                for (; end - p >= 8; p += 8, q += 8) {
+                    std::uint64_t x, y;
+                    std::memcpy(&x, p, sizeof(x));
+                    std::memcpy(&y, q, sizeof(y));
+                    if (x != y) {
+                        return static_cast<std::size_t>(p - start) + static_cast<std::size_t>(std::countr_zero(x ^ y) / 8);
+                    }
+                }
+            }
+
+            for (; p != end && *p == *q; ++p, ++q) {}
+
+            return static_cast<std::size_t>(p - start);
+
+        }
+
+        inline unsigned char* Lz4::write_length(unsigned char* dst, std::size_t len) noexcept {
+            for (; len >= 255; len -= 255) {
+                *dst++ = 255;
+            }
+            *dst++ = static_cast<unsigned char>(len);
+            return dst;
+        }
+
 }
@@ -14,11 +14,13 @@
 #include <format>
 #include <iterator>
 #include <ranges>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <system_error>
 #include <utility>
+#include <vector>
 
 #ifdef _WIN32
 
@@ -29,6 +31,10 @@
 
 #else
 
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/uio.h>
     #include <unistd.h>
 
 #endif
@@ -87,6 +93,7 @@ namespace RS {
         virtual bool is_tty() const noexcept = 0;
         virtual std::size_t read(void* ptr, std::size_t len) = 0;
         virtual std::string read_all();
+        virtual std::size_t read_all_into(std::string& buf);
         virtual std::size_t read_into(std::string& buf, std::size_t pos = 0);
         virtual std::string read_full_line();
         virtual std::string read_str(std::size_t len);
@@ -112,7 +119,9 @@ namespace RS {
 
     protected:
 
+        static void resize_uninitialized(std::string& buf, std::size_t n);
         static void trim_line(std::string& line) noexcept;
+        static void trim_line(std::string_view& line) noexcept;
 
         #ifdef _WIN32
             static std::wstring quick_wstring(const char* cptr);
@@ -139,38 +148,62 @@ namespace RS {
 
         inline std::string IO::read_all() {
 
-            static constexpr auto block_size = 4096uz;
+            static constexpr auto small_size = 2048uz;
 
             std::string buf;
+            read_all_into(buf);
 
-            if (can_seek()) {
+            if (buf.size() < small_size) {
+                buf.shrink_to_fit();
+            }
 
-                auto start = tell();
-                seek(0, end);
-                auto signed_size = tell() - start;
-                seek(- signed_size, current);
-                auto size = to_unsigned(signed_size);
-                buf.resize(size);
-                read(buf.data(), size);
+            return buf;
 
-            } else {
+        }
+
+        inline std::size_t IO::read_all_into(std::string& buf) {
+
+            static constexpr auto block_size = 4096uz;
 
-                auto count = 0uz;
+            // If the stream is seekable, size the buffer to hold the expected
+            // data plus one byte, so end of file is normally detected without
+            // growing the buffer. Keep reading until end of file anyway, in
+            // case the reported size was wrong. The buffer is grown
+            // geometrically, without zero filling.
 
-                do {
-                    auto offset = buf.size();
-                    buf.resize(offset + block_size);
-                    count = read(buf.data() + offset, block_size);
-                    buf.resize(offset + count);
-                } while (count > 0);
+            auto capacity = std::max(buf.capacity(), block_size);
 
+            if (can_seek()) {
+                auto start = tell();
+                seek(0, end);
+                auto signed_size = tell() - start;
+                seek(- signed_size, current);
+                capacity = std::max(capacity, to_unsigned(signed_size) + 1);
             }
 
-            if (buf.size() < block_size / 2) {
-                buf.shrink_to_fit();
+            auto size = 0uz;
+
+            try {
+                for (;;) {
+                    if (size == capacity) {
+                        capacity *= 2;
+                    }
+                    resize_uninitialized(buf, capacity);
+                    auto n = read(buf.data() + size, capacity - size);
+                    if (n == 0) {
+                        break;
+                    }
+                    size += n;
+                }
+            }
+            catch (...) {
+                buf.resize(size);
+                throw;
             }
 
-            return buf;
+            buf.resize(size);
+
+            return size;
 
         }
 
@@ -203,12 +236,30 @@ namespace RS {
         }
 
         inline std::string IO::read_str(std::size_t len) {
-            std::string str(len, '\0');
-            auto n = read_into(str);
+            std::string str;
+            resize_uninitialized(str, len);
+            auto n = 0uz;
+            try {
+                n = read_into(str);
+            }
+            catch (...) {
+                str.clear();
+                throw;
+            }
             str.resize(n);
             return str;
         }
 
+        inline void IO::resize_uninitialized(std::string& buf, std::size_t n) {
+
+            // The callback must not throw, so nothing is read inside it.
+            // Return the requested size, because some implementations pass
+            // in the capacity.
+
+            buf.resize_and_overwrite(n, [n] (char*, std::size_t) { return n; });
+
+        }
+
         inline void IO::trim_line(std::string& line) noexcept {
             if (! line.empty() && line.back() == '\n') {
                 line.pop_back();
@@ -218,6 +269,15 @@ namespace RS {
             }
         }
 
+        inline void IO::trim_line(std::string_view& line) noexcept {
+            if (line.ends_with('\n')) {
+                line.remove_suffix(1);
+                if (line.ends_with('\r')) {
+                    line.remove_suffix(1);
+                }
+            }
+        }
+
         #ifdef _WIN32
 
             inline std::wstring IO::quick_wstring(const char* cptr) {
@@ -493,6 +553,7 @@ namespace RS {
         bool is_tty() const noexcept override { return false; }
         std::size_t read(void* ptr, std::size_t len) override;
         std::string read_all() override;
+        std::size_t read_all_into(std::string& buf) override;
         std::string read_full_line() override;
         std::string read_str(std::size_t len) override;
         void seek(std::ptrdiff_t offset, IOSeek from = current) override;
@@ -550,6 +611,12 @@ namespace RS {
             return result;
         }
 
+        inline std::size_t StringBuffer::read_all_into(std::string& buf) {
+            buf.assign(*buf_ptr_, pos_);
+            pos_ = buf_ptr_->size();
+            return buf.size();
+        }
+
         inline std::string StringBuffer::read_full_line() {
             auto next = buf_ptr_->find('\n', pos_);
             if (next == npos) {
@@ -599,4 +666,754 @@ namespace RS {
             owner_ = true;
         }
 
+    namespace Detail {
+
+        // Iterator over lines returned by read_line_view(), which returns a
+        // null view at end of file
+
+        template <typename T>
+        class LineViewIterator:
+        public Iterator<LineViewIterator<T>, const std::string_view, std::input_iterator_tag> {
+        public:
+            LineViewIterator() {}
+            explicit LineViewIterator(T& io, bool trim): io_{&io}, trim_{trim} { ++*this; }
+            const std::string_view& operator*() const noexcept { return line_; }
+            LineViewIterator& operator++() {
+                line_ = io_->read_line_view(trim_);
+                if (line_.data() == nullptr) {
+                    io_ = nullptr;
+                }
+                return *this;
+            }
+            bool operator==(const LineViewIterator& i) const noexcept { return io_ == i.io_; }
+            bool operator==(std::nullptr_t) const noexcept { return io_ == nullptr; }
+        private:
+            T* io_ = nullptr;
+            std::string_view line_;
+            bool trim_ = false;
+        };
+
+    }
+
+    class BufferedIO:
+    public IO {
+
+    public:
+
+        using iterator = Detail::LineViewIterator<BufferedIO>;
+        using view_range = std::ranges::subrange<iterator, std::nullptr_t>;
+
+        static constexpr std::size_t default_buffer_size = 65'536;
+
+        BufferedIO() = default;
+        explicit BufferedIO(IO& io, std::size_t buffer_size = default_buffer_size);
+
+        bool can_seek() const noexcept override { return io_ != nullptr && io_->can_seek(); }
+        void close() override;
+        void flush() override;
+        bool get(char& c) override;
+        bool is_tty() const noexcept override { return io_ != nullptr && io_->is_tty(); }
+        void put(char c) override;
+        std::size_t read(void* ptr, std::size_t len) override;
+        std::string read_full_line() override;
+        void seek(std::ptrdiff_t offset = 0, IOSeek from = current) override;
+        std::ptrdiff_t tell() const override;
+        std::size_t write(const void* ptr, std::size_t len) override;
+
+        IO* base() const noexcept { return io_; }
+        std::size_t buffered() const noexcept { return end_ - pos_; }
+        view_range line_views(bool trim = false) { return {iterator{*this, trim}, {}}; }
+        std::string_view read_line_view(bool trim = false);
+
+    private:
+
+        IO* io_ = nullptr;
+        std::string buf_;
+        std::size_t pos_ = 0;
+        std::size_t end_ = 0;
+
+        bool fill();
+        void sync();
+        IO& target() const;
+
+    };
+
+        inline BufferedIO::BufferedIO(IO& io, std::size_t buffer_size):
+        io_{&io},
+        buf_(std::max(buffer_size, 1uz), '\0') {}
+
+        inline void BufferedIO::close() {
+
+            // The underlying stream is not owned by the adaptor, so it is
+            // left open, at the logical position if it can seek
+
+            if (io_ != nullptr) {
+                sync();
+            }
+
+            io_ = nullptr;
+            buf_ = {};
+            pos_ = end_ = 0;
+
+        }
+
+        inline void BufferedIO::flush() {
+            if (io_ != nullptr) {
+                io_->flush();
+            }
+        }
+
+        inline bool BufferedIO::get(char& c) {
+            if (pos_ == end_ && ! fill()) {
+                return false;
+            }
+            c = buf_[pos_++];
+            return true;
+        }
+
+        inline void BufferedIO::put(char c) {
+            auto& io = target();
+            sync();
+            io.put(c);
+        }
+
+        inline std::size_t BufferedIO::read(void* ptr, std::size_t len) {
+
+            auto out = static_cast<char*>(ptr);
+            auto n = std::min(len, end_ - pos_);
+            std::memcpy(out, buf_.data() + pos_, n);
+            pos_ += n;
+
+            if (n == len || io_ == nullptr) {
+                return n;
+            }
+
+            // Large reads bypass the buffer
+
+            if (len - n >= buf_.size()) {
+                return n + io_->read(out + n, len - n);
+            }
+
+            if (! fill()) {
+                return n;
+            }
+
+            auto m = std::min(len - n, end_ - pos_);
+            std::memcpy(out + n, buf_.data() + pos_, m);
+            pos_ += m;
+
+            return n + m;
+
+        }
+
+        inline std::string BufferedIO::read_full_line() {
+            auto line = read_line_view();
+            return {line.begin(), line.end()};
+        }
+
+        inline std::string_view BufferedIO::read_line_view(bool trim) {
+
+            // Returns a null view at end of file, so an empty line can still
+            // be distinguished after trimming
+
+            auto scan = pos_;
+
+            for (;;) {
+
+                auto ptr = static_cast<const char*>(std::memchr(buf_.data() + scan, '\n', end_ - scan));
+
+                if (ptr != nullptr) {
+                    auto stop = to_unsigned(ptr - buf_.data()) + 1;
+                    std::string_view line {buf_.data() + pos_, stop - pos_};
+                    pos_ = stop;
+                    if (trim) {
+                        trim_line(line);
+                    }
+                    return line;
+                }
+
+                scan = end_ - pos_;
+
+                if (! fill()) {
+                    break;
+                }
+
+            }
+
+            if (pos_ == end_) {
+                return {};
+            }
+
+            std::string_view line {buf_.data() + pos_, end_ - pos_};
+            pos_ = end_;
+
+            if (trim) {
+                trim_line(line);
+            }
+
+            return line;
+
+        }
+
+        inline void BufferedIO::seek(std::ptrdiff_t offset, IOSeek from) {
+            auto& io = target();
+            sync();
+            io.seek(offset, from);
+        }
+
+        inline std::ptrdiff_t BufferedIO::tell() const {
+            if (io_ == nullptr) {
+                return 0;
+            }
+            return io_->tell() - to_signed(end_ - pos_);
+        }
+
+        inline std::size_t BufferedIO::write(const void* ptr, std::size_t len) {
+            auto& io = target();
+            sync();
+            return io.write(ptr, len);
+        }
+
+        inline bool BufferedIO::fill() {
+
+            // Moves any unread data to the start of the buffer, doubling the
+            // buffer if it is already full, then reads as much as will fit.
+            // Returns false if nothing more could be read
+
+            if (io_ == nullptr) {
+                return false;
+            }
+
+            if (pos_ > 0) {
+                std::memmove(buf_.data(), buf_.data() + pos_, end_ - pos_);
+                end_ -= pos_;
+                pos_ = 0;
+            }
+
+            if (end_ == buf_.size()) {
+                buf_.resize(2 * buf_.size());
+            }
+
+            auto n = io_->read(buf_.data() + end_, buf_.size() - end_);
+            end_ += n;
+
+            return n > 0;
+
+        }
+
+        inline void BufferedIO::sync() {
+
+            // Discards read-ahead data, moving the underlying stream back to
+            // the logical position if possible
+
+            if (pos_ < end_ && io_->can_seek()) {
+                io_->seek(- to_signed(end_ - pos_), current);
+            }
+
+            pos_ = end_ = 0;
+
+        }
+
+        inline IO& BufferedIO::target() const {
+            if (io_ == nullptr) {
+                throw std::system_error(std::make_error_code(std::errc::bad_file_descriptor));
+            }
+            return *io_;
+        }
+
+    #ifndef _WIN32
+
+        class MmapFile:
+        public IO {
+
+        public:
+
+            enum class access: int {
+                normal,
+                sequential,
+                random,
+            };
+
+            using iterator = Detail::LineViewIterator<MmapFile>;
+            using view_range = std::ranges::subrange<iterator, std::nullptr_t>;
+
+            MmapFile() = default;
+            explicit MmapFile(const std::filesystem::path& path, access hint = access::normal);
+            MmapFile(const MmapFile&) = delete;
+            MmapFile(MmapFile&& m) noexcept;
+            ~MmapFile() noexcept override { unmap(); }
+            MmapFile& operator=(const MmapFile&) = delete;
+            MmapFile& operator=(MmapFile&& m) noexcept;
+
+            bool can_seek() const noexcept override { return true; }
+            void close() override { unmap(); }
+            bool get(char& c) override;
+            bool is_tty() const noexcept override { return false; }
+            std::size_t read(void* ptr, std::size_t len) override;
+            std::string read_all() override;
+            std::size_t read_all_into(std::string& buf) override;
+            std::string read_full_line() override;
+            std::string read_str(std::size_t len) override;
+            void seek(std::ptrdiff_t offset = 0, IOSeek from = current) override;
+            std::ptrdiff_t tell() const override { return to_signed(pos_); }
+            std::size_t write(const void* ptr, std::size_t len) override;
+
+            void advise(access hint) noexcept;
+            bool empty() const noexcept { return size_ == 0; }
+            view_range line_views(bool trim = false) { return {iterator{*this, trim}, {}}; }
+            std::string_view read_line_view(bool trim = false);
+            std::size_t size() const noexcept { return size_; }
+            std::string_view view() const noexcept { return {data_, size_}; }
+
+        private:
+
+            const char* data_ = nullptr;
+            std::size_t size_ = 0;
+            std::size_t pos_ = 0;
+
+            void unmap() noexcept;
+
+        };
+
+            inline MmapFile::MmapFile(const std::filesystem::path& path, access hint) {
+
+                // Open without blocking so that a FIFO with no writer can be
+                // rejected below, instead of hanging here
+
+                auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+
+                if (fd == -1) {
+                    throw std::system_error(std::error_code(errno, std::system_category()), path.string());
+                }
+
+                // Only regular files have a meaningful size; devices and
+                // FIFOs report zero
+
+                struct stat info {};
+                auto err = ::fstat(fd, &info) == 0 ? 0 : errno;
+
+                if (err == 0 && ! S_ISREG(info.st_mode)) {
+                    err = S_ISDIR(info.st_mode) ? EISDIR : ENODEV;
+                }
+
+                if (err == 0 && info.st_size > 0) {
+
+                    // The mapping remains valid after the descriptor is closed
+
+                    auto size = static_cast<std::size_t>(info.st_size);
+                    auto ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+                    if (ptr == MAP_FAILED) {
+                        err = errno;
+                    } else {
+                        data_ = static_cast<const char*>(ptr);
+                        size_ = size;
+                    }
+
+                }
+
+                ::close(fd);
+
+                if (err != 0) {
+                    throw std::system_error(std::error_code(err, std::system_category()), path.string());
+                }
+
+                advise(hint);
+
+            }
+
+            inline MmapFile::MmapFile(MmapFile&& m) noexcept:
+            data_{std::exchange(m.data_, nullptr)},
+            size_{std::exchange(m.size_, 0)},
+            pos_{std::exchange(m.pos_, 0)} {}
+
+            inline MmapFile& MmapFile::operator=(MmapFile&& m) noexcept {
+                if (&m != this) {
+                    unmap();
+                    data_ = std::exchange(m.data_, nullptr);
+                    size_ = std::exchange(m.size_, 0);
+                    pos_ = std::exchange(m.pos_, 0);
+                }
+                return *this;
+            }
+
+            inline bool MmapFile::get(char& c) {
+                if (pos_ == size_) {
+                    return false;
+                }
+                c = data_[pos_++];
+                return true;
+            }
+
+            inline std::size_t MmapFile::read(void* ptr, std::size_t len) {
+                auto n = std::min(len, size_ - pos_);
+                if (n > 0) {
+                    std::memcpy(ptr, data_ + pos_, n);
+                }
+                pos_ += n;
+                return n;
+            }
+
+            inline std::string MmapFile::read_all() {
+                std::string result {view().substr(pos_)};
+                pos_ = size_;
+                return result;
+            }
+
+            inline std::size_t MmapFile::read_all_into(std::string& buf) {
+                buf.assign(view().substr(pos_));
+                pos_ = size_;
+                return buf.size();
+            }
+
+            inline std::string MmapFile::read_full_line() {
+                auto line = read_line_view();
+                return {line.begin(), line.end()};
+            }
+
+            inline std::string MmapFile::read_str(std::size_t len) {
+                std::string result {view().substr(pos_, len)};
+                pos_ += result.size();
+                return result;
+            }
+
+            inline void MmapFile::seek(std::ptrdiff_t offset, IOSeek from) {
+                auto signed_pos = to_signed(pos_);
+                auto signed_size = to_signed(size_);
+                switch (from) {
+                    case set:  signed_pos = offset; break;
+                    case end:  signed_pos = signed_size + offset; break;
+                    default:   signed_pos += offset; break;
+                }
+                pos_ = to_unsigned(std::clamp(signed_pos, 0z, signed_size));
+            }
+
+            inline std::size_t MmapFile::write(const void* /*ptr*/, std::size_t /*len*/) {
+                throw std::system_error(std::make_error_code(std::errc::bad_file_descriptor));
+            }
+
+            inline void MmapFile::advise(access hint) noexcept {
+
+                // This is only a hint, so failure is ignored
+
+                if (data_ == nullptr) {
+                    return;
+                }
+
+                int advice;
+
+                switch (hint) {
+                    case access::sequential:  advice = MADV_SEQUENTIAL; break;
+                    case access::random:      advice = MADV_RANDOM; break;
+                    default:                  advice = MADV_NORMAL; break;
+                }
+
+                ::madvise(const_cast<char*>(data_), size_, advice);
+
+            }
+
+            inline std::string_view MmapFile::read_line_view(bool trim) {
+
+                if (pos_ == size_) {
+                    return {};
+                }
+
+                auto ptr = static_cast<const char*>(std::memchr(data_ + pos_, '\n', size_ - pos_));
+                auto stop = ptr == nullptr ? size_ : to_unsigned(ptr - data_) + 1;
+                std::string_view line {data_ + pos_, stop - pos_};
+                pos_ = stop;
+
+                if (trim) {
+                    trim_line(line);
+                }
+
+                return line;
+
+            }
+
+            inline void MmapFile::unmap() noexcept {
+                if (data_ != nullptr) {
+                    ::munmap(const_cast<char*>(data_), size_);
+                }
+                data_ = nullptr;
+                size_ = pos_ = 0;
+            }
+
+        class Fdio:
+        public IO {
+
+        public:
+
+            Fdio() = default;
+            explicit Fdio(const std::filesystem::path& path, IOMode mode = read_only);
+            explicit Fdio(const std::filesystem::path& path, int flags, int permissions = 0666);
+            explicit Fdio(int fd) noexcept: fd_(fd), owner_(fd > 2) {}
+            explicit Fdio(int fd, bool own);
+            Fdio(const Fdio&) = delete;
+            Fdio(Fdio&& io) noexcept: fd_(std::exchange(io.fd_, -1)), owner_(std::exchange(io.owner_, false)) {}
+            ~Fdio() noexcept override { close_fd(false); }
+            Fdio& operator=(const Fdio&) = delete;
+            Fdio& operator=(Fdio&& io) noexcept;
+
+            bool can_seek() const noexcept override { return ::lseek(fd_, 0, SEEK_CUR) != -1; }
+            void close() override { close_fd(true); }
+            bool is_tty() const noexcept override { return ::isatty(fd_) != 0; }
+            std::size_t read(void* ptr, std::size_t len) override;
+            void seek(std::ptrdiff_t offset = 0, IOSeek from = current) override;
+            std::ptrdiff_t tell() const override;
+            std::size_t write(const void* ptr, std::size_t len) override;
+
+            int handle() const noexcept { return fd_; }
+            std::size_t pread(void* ptr, std::size_t len, std::ptrdiff_t offset) const;
+            std::size_t pwrite(const void* ptr, std::size_t len, std::ptrdiff_t offset);
+            std::size_t readv(std::span<const std::span<char>> buffers);
+            int release() noexcept;
+            std::size_t writev(std::span<const std::string_view> buffers);
+
+        private:
+
+            int fd_ = -1;
+            bool owner_ = false;
+
+            void close_fd(bool checked);
+            std::size_t transfer_vector(::iovec* vec, std::size_t count, bool writing);
+
+            static void check(long rc, const std::string& path = {});
+            static int translate_mode(IOMode mode) noexcept;
+
+        };
+
+            inline Fdio::Fdio(const std::filesystem::path& path, IOMode mode) {
+                if ((path.empty() || path == "-") && mode != read_write) {
+                    fd_ = mode == read_only ? 0 : 1;
+                } else {
+                    *this = Fdio(path, translate_mode(mode));
+                }
+            }
+
+            inline Fdio::Fdio(const std::filesystem::path& path, int flags, int permissions) {
+                auto fd = ::open(path.c_str(), flags | O_CLOEXEC, static_cast<::mode_t>(permissions));
+                check(fd, path.string());
+                fd_ = fd;
+                owner_ = true;
+            }
+
+            inline Fdio::Fdio(int fd, bool own):
+            fd_(fd),
+            owner_(own) {
+                if (fd >= 0 && fd <= 2 && own) {
+                    throw std::invalid_argument("Can't take ownership of a standard stream");
+                }
+            }
+
+            inline Fdio& Fdio::operator=(Fdio&& io) noexcept {
+                if (&io != this) {
+                    close_fd(false);
+                    fd_ = std::exchange(io.fd_, -1);
+                    owner_ = std::exchange(io.owner_, false);
+                }
+                return *this;
+            }
+
+            inline std::size_t Fdio::read(void* ptr, std::size_t len) {
+
+                // Loop until the buffer is full or end of file, for
+                // consistency with fread()
+
+                auto out = static_cast<char*>(ptr);
+                auto n = 0uz;
+
+                while (n < len) {
+                    auto rc = ::read(fd_, out + n, len - n);
+                    if (rc == -1 && errno == EINTR) {
+                        continue;
+                    }
+                    check(rc);
+                    if (rc == 0) {
+                        break;
+                    }
+                    n += static_cast<std::size_t>(rc);
+                }
+
+                return n;
+
+            }
+
+            inline void Fdio::seek(std::ptrdiff_t offset, IOSeek from) {
+                check(::lseek(fd_, static_cast<::off_t>(offset), static_cast<int>(from)));
+            }
+
+            inline std::ptrdiff_t Fdio::tell() const {
+                auto pos = ::lseek(fd_, 0, SEEK_CUR);
+                check(pos);
+                return static_cast<std::ptrdiff_t>(pos);
+            }
+
+            inline std::size_t Fdio::write(const void* ptr, std::size_t len) {
+
+                auto in = static_cast<const char*>(ptr);
+                auto n = 0uz;
+
+                while (n < len) {
+                    auto rc = ::write(fd_, in + n, len - n);
+                    if (rc == -1 && errno == EINTR) {
+                        continue;
+                    }
+                    check(rc);
+                    n += static_cast<std::size_t>(rc);
+                }
+
+                return n;
+
+            }
+
+            inline std::size_t Fdio::pread(void* ptr, std::size_t len, std::ptrdiff_t offset) const {
+
+                auto out = static_cast<char*>(ptr);
+                auto n = 0uz;
+
+                while (n < len) {
+                    auto rc = ::pread(fd_, out + n, len - n, static_cast<::off_t>(offset) + static_cast<::off_t>(n));
+                    if (rc == -1 && errno == EINTR) {
+                        continue;
+                    }
+                    check(rc);
+                    if (rc == 0) {
+                        break;
+                    }
+                    n += static_cast<std::size_t>(rc);
+                }
+
+                return n;
+
+            }
+
+            inline std::size_t Fdio::pwrite(const void* ptr, std::size_t len, std::ptrdiff_t offset) {
+
+                auto in = static_cast<const char*>(ptr);
+                auto n = 0uz;
+
+                while (n < len) {
+                    auto rc = ::pwrite(fd_, in + n, len - n, static_cast<::off_t>(offset) + static_cast<::off_t>(n));
+                    if (rc == -1 && errno == EINTR) {
+                        continue;
+                    }
+                    check(rc);
+                    n += static_cast<std::size_t>(rc);
+                }
+
+                return n;
+
+            }
+
+            inline std::size_t Fdio::readv(std::span<const std::span<char>> buffers) {
+                std::vector<::iovec> vec(buffers.size());
+                for (auto i = 0uz; i < buffers.size(); ++i) {
+                    vec[i] = {buffers[i].data(), buffers[i].size()};
+                }
+                return transfer_vector(vec.data(), vec.size(), false);
+            }
+
+            inline int Fdio::release() noexcept {
+                owner_ = false;
+                return std::exchange(fd_, -1);
+            }
+
+            inline std::size_t Fdio::writev(std::span<const std::string_view> buffers) {
+                std::vector<::iovec> vec(buffers.size());
+                for (auto i = 0uz; i < buffers.size(); ++i) {
+                    vec[i] = {const_cast<char*>(buffers[i].data()), buffers[i].size()};
+                }
+                return transfer_vector(vec.data(), vec.size(), true);
+            }
+
+            inline void Fdio::close_fd(bool checked) {
+                if (owner_ && fd_ != -1) {
+                    auto rc = ::close(fd_);
+                    auto err = errno;
+                    fd_ = -1;
+                    owner_ = false;
+                    if (checked && rc == -1) {
+                        errno = err;
+                        check(rc);
+                    }
+                } else {
+                    fd_ = -1;
+                }
+            }
+
+            inline std::size_t Fdio::transfer_vector(::iovec* vec, std::size_t count, bool writing) {
+
+                // Repeat the call after a partial transfer, advancing through
+                // the vector, until everything has been transferred or a read
+                // reaches end of file
+
+                static const auto max_count = static_cast<std::size_t>(::sysconf(_SC_IOV_MAX));
+
+                auto total = 0uz;
+
+                while (count > 0 && vec->iov_len == 0) {
+                    ++vec;
+                    --count;
+                }
+
+                while (count > 0) {
+
+                    auto n = static_cast<int>(std::min(count, max_count));
+                    auto rc = writing ? ::writev(fd_, vec, n) : ::readv(fd_, vec, n);
+
+                    if (rc == -1 && errno == EINTR) {
+                        continue;
+                    }
+
+                    check(rc);
+
+                    if (rc == 0) {
+                        break;
+                    }
+
+                    auto done = static_cast<std::size_t>(rc);
+                    total += done;
+
+                    while (count > 0 && done >= vec->iov_len) {
+                        done -= vec->iov_len;
+                        ++vec;
+                        --count;
+                    }
+
+                    if (count > 0) {
+                        vec->iov_base = static_cast<char*>(vec->iov_base) + done;
+                        vec->iov_len -= done;
+                    }
+
+                }
+
+                return total;
+
+            }
+
+            inline void Fdio::check(long rc, const std::string& path) {
+                if (rc != -1) {
+                    return;
+                }
+                std::error_code code(errno, std::system_category());
+                if (path.empty()) {
+                    throw std::system_error(code);
+                } else {
+                    throw std::system_error(code, path);
+                }
+            }
+
+            inline int Fdio::translate_mode(IOMode mode) noexcept {
+                switch (mode) {
+                    case read_only:   return O_RDONLY;
+                    case write_only:  return O_WRONLY | O_CREAT | O_TRUNC;
+                    case read_write:  return O_RDWR;
+                    case append:      return O_WRONLY | O_CREAT | O_APPEND;
+                    default:          std::unreachable();
+                }
+            }
+
+    #endif
+
 }
@@ -1,25 +1,34 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cerrno>
 #include <chrono>
 #include <concepts>
 #include <condition_variable>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
-#include <deque>
+#include <cstring>
 #include <exception>
 #include <filesystem>
 #include <format>
-#include <functional>
+#include <iterator>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <random>
+#include <ranges>
 #include <source_location>
 #include <string>
 #include <string_view>
 #include <system_error>
 #include <thread>
+#include <tuple>
 #include <type_traits>
+#include <vector>
 
 #ifdef _WIN32
 
@@ -73,6 +82,34 @@ namespace RS {
         return static_cast<LogFlags>(static_cast<U>(a) & static_cast<U>(b));
     }
 
+    namespace Detail {
+
+        // Log arguments that can be copied into a message and formatted
+        // later. Strings are copied by value; other class types may refer
+        // to memory that will not outlive the call, so they are formatted
+        // immediately. Pointers are only deferred if the standard formatter
+        // prints the address; a user defined formatter for any other pointer
+        // type may dereference it.
+
+        template <typename T>
+        concept LogStringArg = std::same_as<T, std::string>
+            || std::same_as<T, std::string_view>
+            || std::same_as<std::decay_t<T>, char*>
+            || std::same_as<std::decay_t<T>, const char*>;
+
+        template <typename T>
+        concept LogDeferredArg = LogStringArg<T>
+            || std::is_arithmetic_v<T>
+            || std::is_enum_v<T>
+            || std::same_as<std::remove_cv_t<T>, void*>
+            || std::same_as<std::remove_cv_t<T>, const void*>
+            || std::same_as<std::remove_cv_t<T>, std::nullptr_t>;
+
+        template <typename T>
+        using LogStoredArg = std::conditional_t<LogStringArg<T>, std::string_view, T>;
+
+    }
+
     class Log {
 
     public:
@@ -81,12 +118,35 @@ namespace RS {
 
         static constexpr auto defaults = file | line | colour;
 
-        struct message {
-            std::function<std::string()> get_message;
-            template <typename... Args> message(std::format_string<const Args&...> fmt, const Args&... args):
-                get_message{[=] { return std::format(fmt, args...); }} {}
+        class message {
+        public:
+            template <typename... Args> message(std::format_string<const Args&...> fmt, const Args&... args);
+        private:
+            friend class Log;
+            static constexpr std::size_t max_args_size = 128;
+            std::string_view format_;
+            void (*formatter_)(const message& msg, std::string& out) = nullptr;
+            std::string text_;
+            alignas(std::max_align_t) std::array<std::byte, max_args_size> args_;
+            template <typename T> bool encode_arg(std::size_t& pos, const T& arg) noexcept;
+            template <typename T> Detail::LogStoredArg<T> decode_arg(std::size_t& pos) const noexcept;
+            template <typename... Args> static void format_deferred(const message& msg, std::string& out);
+            void format_to(std::string& out) const;
+        };
+
+        struct flush_policy {
+            std::size_t messages = 1;                  // Flush after this many messages (0 = never)
+            std::chrono::milliseconds interval {0};    // Flush after this much time (0 = never)
         };
 
+        enum class overflow: int {
+            block,   // Wait until there is space in the buffer
+            drop,    // Discard the entry
+            report,  // Discard the entry, and log the number discarded
+        };
+
+        static constexpr std::size_t default_buffer_size = 1024;
+
         Log(): out_{stderr} {}
         explicit Log(const std::filesystem::path& path, LogFlags flags = defaults);
         explicit Log(std::FILE* out, LogFlags flags = defaults);
@@ -98,6 +158,14 @@ namespace RS {
         Log& operator=(Log&&) = delete;
 
         void enable(bool state);
+        void flush();
+        flush_policy policy() const;
+        void set_policy(const flush_policy& fp);
+        overflow on_overflow() const noexcept { return overflow_.load(std::memory_order::relaxed); }
+        void set_on_overflow(overflow op) noexcept { overflow_.store(op, std::memory_order::relaxed); }
+        std::size_t buffer_size() const noexcept { return buffer_size_.load(std::memory_order::relaxed); }
+        void set_buffer_size(std::size_t n) noexcept { buffer_size_.store(std::max(n, 2uz), std::memory_order::relaxed); }
+        std::uint64_t dropped() const noexcept { return dropped_.load(std::memory_order::relaxed); }
         void operator()(const message& msg, const std::source_location loc = std::source_location::current());
 
     private:
@@ -120,6 +188,9 @@ namespace RS {
 
         using clock = std::chrono::system_clock;
 
+        // A flush request is queued like a log entry, with a flag that the
+        // output thread sets when everything before it has been flushed
+
         struct log_entry {
 
             std::source_location where;
@@ -127,26 +198,105 @@ namespace RS {
             clock::time_point when;
             process_id process;
             thread_id thread;
+            std::shared_ptr<bool> flushed;
 
-            log_entry(std::source_location loc, const message& msg):
+            log_entry(std::source_location loc, const message& msg, bool with_process):
                 where{loc},
                 what{msg},
                 when{clock::now()},
-                process{get_current_process()},
+                process{with_process ? get_current_process() : process_id{}},
                 thread{get_current_thread()} {}
 
+            explicit log_entry(std::shared_ptr<bool> flag):
+                where{},
+                what{""},
+                when{clock::now()},
+                process{},
+                thread{},
+                flushed{std::move(flag)} {}
+
+        };
+
+        // Bounded single producer, single consumer queue. Each thread that
+        // writes to a log has its own, so producers never contend with each
+        // other, and only touch the mutex to wake the output thread.
+
+        class ring_buffer {
+
+        public:
+
+            std::atomic<bool> closed {false};
+
+            explicit ring_buffer(std::size_t n):
+                slots_(std::bit_ceil(n)),
+                mask_{slots_.size() - 1} {}
+
+            bool empty() const noexcept {
+                return head_.load(std::memory_order::seq_cst) == tail_.load(std::memory_order::relaxed);
+            }
+
+            bool push(log_entry& entry) noexcept {
+                auto h = head_.load(std::memory_order::relaxed);
+                if (h - tail_.load(std::memory_order::acquire) == slots_.size()) {
+                    return false;
+                }
+                slots_[h & mask_].emplace(std::move(entry));
+                head_.store(h + 1, std::memory_order::seq_cst);
+                return true;
+            }
+
+            template <typename F>
+            void drain(F f) {
+                auto t = tail_.load(std::memory_order::relaxed);
+                auto h = head_.load(std::memory_order::acquire);
+                for (; t != h; ++t) {
+                    auto& slot = slots_[t & mask_];
+                    f(std::move(*slot));
+                    slot.reset();
+                    tail_.store(t + 1, std::memory_order::release);
+                }
+            }
+
+        private:
+
+            std::vector<std::optional<log_entry>> slots_;
+            std::size_t mask_;
+            alignas(64) std::atomic<std::size_t> head_ {0};
+            alignas(64) std::atomic<std::size_t> tail_ {0};
+
         };
 
-        std::deque<log_entry> queue_;
-        std::mutex mutex_;
+        using ring_ptr = std::shared_ptr<ring_buffer>;
+
+        // Thread local buffer caches are keyed by a unique ID rather than
+        // the Log's address, which could be reused by a later Log
+
+        static inline std::atomic<std::uint64_t> next_id_ {0};
+
+        const std::uint64_t id_ {++next_id_};
+        std::vector<ring_ptr> rings_;
+        mutable std::mutex mutex_;
         std::condition_variable cv_;
+        std::condition_variable flushed_cv_;
         std::jthread thread_;
         std::filesystem::path path_;
         std::FILE* out_ {nullptr};
         LogFlags flags_ {defaults};
+        flush_policy policy_;
+        std::atomic<overflow> overflow_ {overflow::block};
+        std::atomic<std::size_t> buffer_size_ {default_buffer_size};
+        std::atomic<std::uint64_t> dropped_ {0};
+        std::uint64_t reported_ {0};
+        std::atomic<bool> enabled_ {false};
+        std::atomic<bool> sleeping_ {false};
+        bool running_ {false};
         bool stop_request_ {false};
 
         void add_context(const log_entry& entry, std::string& text) const;
+        bool any_pending() const noexcept;
+        ring_buffer& local_ring();
+        bool push_entry(log_entry& entry);
+        void wake_payload();
         void payload() noexcept;
 
         static std::string_view file_leaf_name(std::string_view path);
@@ -161,6 +311,110 @@ namespace RS {
 
     };
 
+        template <typename... Args>
+        Log::message::message(std::format_string<const Args&...> fmt, const Args&... args):
+        format_{fmt.get()} {
+
+            // If every argument can be copied into the fixed size buffer,
+            // formatting is deferred to the output thread; otherwise the
+            // message is formatted now
+
+            if constexpr ((Detail::LogDeferredArg<Args> && ...)) {
+                auto pos = 0uz;
+                if ((encode_arg(pos, args) && ...)) {
+                    formatter_ = &format_deferred<Args...>;
+                    return;
+                }
+            }
+
+            text_ = std::format(fmt, args...);
+
+        }
+
+        template <typename T>
+        bool Log::message::encode_arg(std::size_t& pos, const T& arg) noexcept {
+
+            if constexpr (Detail::LogStringArg<T>) {
+
+                std::string_view view {arg};
+                auto size = view.size();
+                pos = (pos + alignof(std::size_t) - 1) & ~(alignof(std::size_t) - 1);
+
+                if (size > max_args_size || pos + sizeof(size) + size > max_args_size) {
+                    return false;
+                }
+
+                std::memcpy(args_.data() + pos, &size, sizeof(size));
+                pos += sizeof(size);
+                std::memcpy(args_.data() + pos, view.data(), size);
+                pos += size;
+
+            } else {
+
+                pos = (pos + alignof(T) - 1) & ~(alignof(T) - 1);
+
+                if (pos + sizeof(T) > max_args_size) {
+                    return false;
+                }
+
+                std::memcpy(args_.data() + pos, &arg, sizeof(T));
+                pos += sizeof(T);
+
+            }
+
+            return true;
+
+        }
+
+        template <typename T>
+        Detail::LogStoredArg<T> Log::message::decode_arg(std::size_t& pos) const noexcept {
+
+            if constexpr (Detail::LogStringArg<T>) {
+
+                std::size_t size;
+                pos = (pos + alignof(std::size_t) - 1) & ~(alignof(std::size_t) - 1);
+                std::memcpy(&size, args_.data() + pos, sizeof(size));
+                pos += sizeof(size);
+                std::string_view view {reinterpret_cast<const char*>(args_.data() + pos), size};
+                pos += size;
+
+                return view;
+
+            } else {
+
+                T value;
+                pos = (pos + alignof(T) - 1) & ~(alignof(T) - 1);
+                std::memcpy(&value, args_.data() + pos, sizeof(T));
+                pos += sizeof(T);
+
+                return value;
+
+            }
+
+        }
+
+        template <typename... Args>
+        void Log::message::format_deferred(const message& msg, std::string& out) {
+
+            // Elements of a braced initializer are evaluated in order
+
+            [[maybe_unused]] auto pos = 0uz;
+            std::tuple<Detail::LogStoredArg<Args>...> values {msg.decode_arg<Args>(pos)...};
+
+            std::apply([&msg, &out] (const auto&... v) {
+                std::vformat_to(std::back_inserter(out), msg.format_, std::make_format_args(v...));
+            }, values);
+
+        }
+
+        inline void Log::message::format_to(std::string& out) const {
+            if (formatter_ == nullptr) {
+                out += text_;
+            } else {
+                formatter_(*this, out);
+            }
+        }
+
         inline Log::Log(const std::filesystem::path& path, LogFlags flags):
         path_{path},
         flags_{flags} {
@@ -175,6 +429,8 @@ namespace RS {
 
         inline Log::~Log() noexcept {
 
+            enabled_ = false;
+
             if (thread_.joinable()) {
 
                 {
@@ -187,6 +443,10 @@ namespace RS {
 
             }
 
+            for (auto& ring: rings_) {
+                ring->closed = true;
+            }
+
             if (! path_.empty() && out_ != nullptr) {
                 std::fclose(out_);
             }
@@ -205,6 +465,7 @@ namespace RS {
                 }
 
                 stop_request_ = ! state;
+                enabled_ = state;
 
                 if (state) {
 
@@ -221,6 +482,7 @@ namespace RS {
 
                     }
 
+                    running_ = true;
                     thread_ = std::jthread{&Log::payload, this};
 
                 }
@@ -234,12 +496,117 @@ namespace RS {
 
         }
 
+        inline void Log::flush() {
+
+            if (! enabled_) {
+                return;
+            }
+
+            auto flag = std::make_shared<bool>(false);
+            log_entry request {flag};
+
+            while (! local_ring().push(request)) {
+                if (! enabled_) {
+                    return;
+                }
+                wake_payload();
+                std::this_thread::yield();
+            }
+
+            wake_payload();
+            std::unique_lock lock {mutex_};
+            flushed_cv_.wait(lock, [this, &flag] { return *flag || ! running_; });
+
+        }
+
+        inline Log::flush_policy Log::policy() const {
+            std::unique_lock lock {mutex_};
+            return policy_;
+        }
+
+        inline void Log::set_policy(const flush_policy& fp) {
+            std::unique_lock lock {mutex_};
+            policy_ = fp;
+            cv_.notify_one();
+        }
+
         inline void Log::operator()(const message& msg, const std::source_location loc) {
-            if (thread_.joinable()) {
+            if (enabled_.load(std::memory_order::relaxed)) {
+                log_entry entry {loc, msg, (flags_ & process) != none};
+                if (push_entry(entry)) {
+                    wake_payload();
+                }
+            }
+        }
+
+        inline bool Log::any_pending() const noexcept {
+            return std::ranges::any_of(rings_, [] (auto& ring) { return ! ring->empty(); });
+        }
+
+        inline Log::ring_buffer& Log::local_ring() {
+
+            // Buffers belonging to destroyed logs are pruned as they are
+            // found
+
+            struct cache_entry {
+                std::uint64_t id;
+                ring_ptr ring;
+            };
+
+            static thread_local std::vector<cache_entry> cache;
+
+            for (auto it = cache.begin(); it != cache.end();) {
+                if (it->id == id_) {
+                    return *it->ring;
+                } else if (it->ring->closed.load(std::memory_order::relaxed)) {
+                    it = cache.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            auto ring = std::make_shared<ring_buffer>(buffer_size_.load(std::memory_order::relaxed));
+
+            {
+                std::unique_lock lock {mutex_};
+                rings_.push_back(ring);
+            }
+
+            cache.push_back({id_, ring});
+
+            return *ring;
+
+        }
+
+        inline bool Log::push_entry(log_entry& entry) {
+
+            auto& ring = local_ring();
+
+            while (! ring.push(entry)) {
+                if (overflow_.load(std::memory_order::relaxed) != overflow::block
+                        || ! enabled_.load(std::memory_order::relaxed)) {
+                    dropped_.fetch_add(1, std::memory_order::relaxed);
+                    return false;
+                }
+                wake_payload();
+                std::this_thread::yield();
+            }
+
+            return true;
+
+        }
+
+        inline void Log::wake_payload() {
+
+            // The output thread sets the sleeping flag before checking the
+            // buffers for the last time, and the producer writes to its
+            // buffer before checking the flag, so a wakeup can't be lost
+
+            if (sleeping_.load(std::memory_order::seq_cst)) {
                 std::unique_lock lock {mutex_};
-                queue_.push_back(log_entry{loc, msg});
                 cv_.notify_one();
             }
+
         }
 
         inline void Log::add_context(const log_entry& entry, std::string& text) const {
@@ -252,7 +619,7 @@ namespace RS {
                 if ((flags_ & mask) == none) {
                     return false;
                 }
-                text += std::format(fmt, t);
+                std::format_to(std::back_inserter(text), fmt, t);
                 text += ':';
                 return true;
             };
@@ -276,37 +643,186 @@ namespace RS {
 
         inline void Log::payload() noexcept {
 
+            // Each pass takes everything in the buffers, formats it without
+            // holding the lock, and writes it in one call. Each buffer's
+            // entries are already in order; entries from different threads
+            // are merged by timestamp within each pass, without reordering
+            // entries from the same thread even if the clock goes backwards.
+            // The stream is flushed according to the flush policy, when
+            // flush() has been called, and before the thread exits.
+
             try {
 
-                std::string prefix, suffix;
+                using namespace std::chrono;
+
+                std::string prefix, suffix, text;
+                std::vector<ring_ptr> rings;
+                std::vector<std::vector<log_entry>> runs;
+                std::vector<std::size_t> heap, positions;
+                std::vector<std::shared_ptr<bool>> requests;
+                auto unflushed = 0uz;
+                auto last_flush = steady_clock::now();
 
                 if ((flags_ & colour) != none && xterm_is_tty(out_))  {
                     prefix = make_prefix();
                     suffix = xterm_reset();
                 }
 
+                // Buffers are only removed at the start of a pass, so a new
+                // snapshot of the buffer list always extends the old one, and
+                // runs[i] always belongs to rings[i]
+
+                auto drain = [&runs, &requests, &rings] {
+                    runs.resize(rings.size());
+                    for (auto i = 0uz; i < rings.size(); ++i) {
+                        rings[i]->drain([&run = runs[i], &requests] (log_entry&& entry) {
+                            if (entry.flushed) {
+                                requests.push_back(std::move(entry.flushed));
+                            } else {
+                                run.push_back(std::move(entry));
+                            }
+                        });
+                    }
+                };
+
+                // K-way merge of the runs, calling f() on each entry in order
+
+                auto merge = [&runs, &heap, &positions] (auto f) {
+
+                    auto later = [&runs, &positions] (std::size_t a, std::size_t b) {
+                        auto& x = runs[a][positions[a]].when;
+                        auto& y = runs[b][positions[b]].when;
+                        return x > y || (x == y && a > b);
+                    };
+
+                    positions.assign(runs.size(), 0);
+                    heap.clear();
+
+                    for (auto i = 0uz; i < runs.size(); ++i) {
+                        if (! runs[i].empty()) {
+                            heap.push_back(i);
+                        }
+                    }
+
+                    std::ranges::make_heap(heap, later);
+
+                    while (! heap.empty()) {
+                        std::ranges::pop_heap(heap, later);
+                        auto r = heap.back();
+                        f(runs[r][positions[r]]);
+                        if (++positions[r] < runs[r].size()) {
+                            std::ranges::push_heap(heap, later);
+                        } else {
+                            heap.pop_back();
+                        }
+                    }
+
+                };
+
                 std::unique_lock lock {mutex_};
 
-                while (! stop_request_ || ! queue_.empty()) {
+                for (;;) {
 
-                    cv_.wait(lock, [this] { return stop_request_ || ! queue_.empty(); });
+                    auto wake = [this] { return stop_request_ || any_pending(); };
+                    sleeping_ = true;
 
-                    if (stop_request_ && queue_.empty()) {
-                        break;
+                    if (unflushed > 0 && policy_.interval > 0ms) {
+                        cv_.wait_until(lock, last_flush + policy_.interval, wake);
+                    } else {
+                        cv_.wait(lock, wake);
                     }
 
-                    auto text{prefix};
-                    add_context(queue_.front(), text);
-                    text += queue_.front().what.get_message();
-                    text += suffix;
-                    text += '\n';
-                    std::fputs(text.data(), out_);
-                    std::fflush(out_);
-                    queue_.pop_front();
+                    sleeping_ = false;
+
+                    // Buffers whose thread has exited can be discarded once
+                    // they are empty
+
+                    std::erase_if(rings_, [] (auto& ring) { return ring.use_count() == 1 && ring->empty(); });
+                    rings = rings_;
+                    auto policy = policy_;
+                    auto flush_now = stop_request_;
+                    lock.unlock();
+
+                    drain();
+
+                    // Anything that was logged before a flush request is
+                    // guaranteed to be visible in a drain that starts after
+                    // the request was seen. That drain may find more
+                    // requests, so repeat until one finds none. The buffer
+                    // list is refreshed because the threads that logged
+                    // those entries may have started since the snapshot.
+
+                    for (auto seen = 0uz; requests.size() > seen;) {
+                        seen = requests.size();
+                        lock.lock();
+                        rings = rings_;
+                        lock.unlock();
+                        drain();
+                        flush_now = true;
+                    }
 
-                }
+                    auto count = 0uz;
+                    text.clear();
+
+                    merge([this, &prefix, &suffix, &text, &count] (log_entry& entry) {
+                        text += prefix;
+                        add_context(entry, text);
+                        entry.what.format_to(text);
+                        text += suffix;
+                        text += '\n';
+                        ++count;
+                    });
+
+                    auto dropped = dropped_.load();
+
+                    if (dropped > reported_ && on_overflow() == overflow::report) {
+                        text += prefix;
+                        std::format_to(std::back_inserter(text), "{} log entries dropped", dropped - reported_);
+                        text += suffix;
+                        text += '\n';
+                        reported_ = dropped;
+                    }
+
+                    if (! text.empty()) {
+                        std::fwrite(text.data(), 1, text.size(), out_);
+                    }
+
+                    unflushed += count;
+                    rings.clear();
+
+                    for (auto& run: runs) {
+                        run.clear();
+                    }
+
+                    auto now = steady_clock::now();
+
+                    if (unflushed > 0) {
+                        flush_now = flush_now
+                            || (policy.messages > 0 && unflushed >= policy.messages)
+                            || (policy.interval > 0ms && now - last_flush >= policy.interval);
+                    }
+
+                    if (flush_now) {
+                        std::fflush(out_);
+                        unflushed = 0;
+                        last_flush = now;
+                    }
+
+                    lock.lock();
 
-                queue_.clear();
+                    if (! requests.empty()) {
+                        for (auto& flag: requests) {
+                            *flag = true;
+                        }
+                        requests.clear();
+                        flushed_cv_.notify_all();
+                    }
+
+                    if (stop_request_ && ! any_pending() && unflushed == 0) {
+                        break;
+                    }
+
+                }
 
             }
 
@@ -320,6 +836,14 @@ namespace RS {
                 std::fputs("Unknown exception while logging", stderr);
             }
 
+            // If the thread died from an exception, producers must not wait
+            // for space that will never be freed
+
+            enabled_ = false;
+            std::unique_lock lock {mutex_};
+            running_ = false;
+            flushed_cv_.notify_all();
+
         }
 
         inline std::string_view Log::file_leaf_name(std::string_view path) {
@@ -5,6 +5,7 @@
 #include "rs-core/global.hpp"
 #include "rs-core/hash.hpp"
 #include <algorithm>
+#include <atomic>
 #include <bit>
 #include <cmath>
 #include <compare>
@@ -15,6 +16,7 @@
 #include <functional>
 #include <initializer_list>
 #include <limits>
+#include <numeric>
 #include <optional>
 #include <ranges>
 #include <stdexcept>
@@ -27,6 +29,193 @@
 
 namespace RS {
 
+    namespace Detail {
+
+        // Word types for multiple precision arithmetic, shared by Natural
+        // and LargeUint. Use 64-bit words where a 128-bit type is available
+        // for products, unless RS_CORE_32_BIT_WORDS is defined.
+
+        #if defined(__GNUC__) && ! defined(RS_CORE_32_BIT_WORDS)
+            using MpWord = std::uint64_t;
+            using MpDoubleWord = __uint128_t;
+            using MpSignedDoubleWord = __int128_t;
+        #else
+            using MpWord = std::uint32_t;
+            using MpDoubleWord = std::uint64_t;
+            using MpSignedDoubleWord = std::int64_t;
+        #endif
+
+        // Vector of trivially copyable elements, stored inline up to N
+        // elements before spilling to the heap. Unlike std::vector, growing
+        // with resize() or insert() fills with the supplied value, and the
+        // heap buffer is never shrunk until destruction.
+
+        template <typename T, std::size_t N>
+        class InlineVector {
+
+        public:
+
+            static_assert(std::is_trivially_copyable_v<T>);
+            static_assert(N >= 1);
+
+            using iterator = T*;
+            using const_iterator = const T*;
+            using value_type = T;
+
+            InlineVector() noexcept {}
+            explicit InlineVector(std::size_t n) { resize(n); }
+            InlineVector(const InlineVector& v) { assign(v.begin(), v.end()); }
+            InlineVector(InlineVector&& v) noexcept { take(v); }
+            ~InlineVector() noexcept { release(); }
+            InlineVector& operator=(const InlineVector& v);
+            InlineVector& operator=(InlineVector&& v) noexcept;
+
+            T& operator[](std::size_t i) noexcept { return data_[i]; }
+            const T& operator[](std::size_t i) const noexcept { return data_[i]; }
+            T* begin() noexcept { return data_; }
+            const T* begin() const noexcept { return data_; }
+            T* end() noexcept { return end_; }
+            const T* end() const noexcept { return end_; }
+            T& back() noexcept { return end_[-1]; }
+            const T& back() const noexcept { return end_[-1]; }
+            T* data() noexcept { return data_; }
+            const T* data() const noexcept { return data_; }
+
+            void assign(std::size_t n, T t);
+            void assign(const T* first, const T* last);
+            std::size_t capacity() const noexcept { return static_cast<std::size_t>(limit_ - data_); }
+            void clear() noexcept { end_ = data_; }
+            bool empty() const noexcept { return end_ == data_; }
+            T* erase(const T* first, const T* last) noexcept;
+            T* insert(const T* pos, std::size_t n, T t);
+            bool is_local() const noexcept { return data_ == local_; }
+            void push_back(T t);
+            void reserve(std::size_t n);
+            void resize(std::size_t n, T t = T{});
+            std::size_t size() const noexcept { return static_cast<std::size_t>(end_ - data_); }
+
+        private:
+
+            // Pointers rather than counts, so stores through the data
+            // pointer cannot alias the bookkeeping
+
+            T* data_ = local_;
+            T* end_ = local_;
+            T* limit_ = local_ + N;
+            T local_[N];
+
+            void release() noexcept;
+            void take(InlineVector& v) noexcept;
+
+        };
+
+            template <typename T, std::size_t N>
+            InlineVector<T, N>& InlineVector<T, N>::operator=(const InlineVector& v) {
+                if (&v != this) {
+                    assign(v.begin(), v.end());
+                }
+                return *this;
+            }
+
+            template <typename T, std::size_t N>
+            InlineVector<T, N>& InlineVector<T, N>::operator=(InlineVector&& v) noexcept {
+                if (&v != this) {
+                    release();
+                    take(v);
+                }
+                return *this;
+            }
+
+            template <typename T, std::size_t N>
+            void InlineVector<T, N>::assign(std::size_t n, T t) {
+                clear();
+                reserve(n);
+                end_ = std::fill_n(data_, n, t);
+            }
+
+            template <typename T, std::size_t N>
+            void InlineVector<T, N>::assign(const T* first, const T* last) {
+                clear();
+                reserve(static_cast<std::size_t>(last - first));
+                end_ = std::copy(first, last, data_);
+            }
+
+            template <typename T, std::size_t N>
+            T* InlineVector<T, N>::erase(const T* first, const T* last) noexcept {
+                auto pos = data_ + (first - data_);
+                end_ = std::copy(data_ + (last - data_), end_, pos);
+                return pos;
+            }
+
+            template <typename T, std::size_t N>
+            T* InlineVector<T, N>::insert(const T* pos, std::size_t n, T t) {
+                auto offset = pos - data_;
+                reserve(size() + n);
+                auto ptr = data_ + offset;
+                std::copy_backward(ptr, end_, end_ + n);
+                std::fill_n(ptr, n, t);
+                end_ += n;
+                return ptr;
+            }
+
+            template <typename T, std::size_t N>
+            void InlineVector<T, N>::push_back(T t) {
+                if (end_ == limit_) {
+                    reserve(2 * capacity());
+                }
+                *end_++ = t;
+            }
+
+            template <typename T, std::size_t N>
+            void InlineVector<T, N>::reserve(std::size_t n) {
+                if (n > capacity()) {
+                    auto new_capacity = std::max(n, 2 * capacity());
+                    auto ptr = new T[new_capacity];
+                    auto new_end = std::copy(data_, end_, ptr);
+                    release();
+                    data_ = ptr;
+                    end_ = new_end;
+                    limit_ = ptr + new_capacity;
+                }
+            }
+
+            template <typename T, std::size_t N>
+            void InlineVector<T, N>::resize(std::size_t n, T t) {
+                auto old_size = size();
+                if (n > old_size) {
+                    reserve(n);
+                    std::fill(end_, data_ + n, t);
+                }
+                end_ = data_ + n;
+            }
+
+            template <typename T, std::size_t N>
+            void InlineVector<T, N>::release() noexcept {
+                if (! is_local()) {
+                    delete[] data_;
+                    data_ = end_ = local_;
+                    limit_ = local_ + N;
+                }
+            }
+
+            template <typename T, std::size_t N>
+            void InlineVector<T, N>::take(InlineVector& v) noexcept {
+                if (v.is_local()) {
+                    data_ = local_;
+                    end_ = std::copy(v.data_, v.end_, local_);
+                    limit_ = local_ + N;
+                } else {
+                    data_ = v.data_;
+                    end_ = v.end_;
+                    limit_ = v.limit_;
+                    v.data_ = v.end_ = v.local_;
+                    v.limit_ = v.local_ + N;
+                }
+                v.clear();
+            }
+
+    }
+
     // Unsigned integer class
 
     class Natural {
@@ -48,7 +237,7 @@ namespace RS {
         Natural operator--(int) { auto x = *this; ++*this; return x; }
         Natural& operator+=(const Natural& y);
         Natural& operator-=(const Natural& y); // Subtraction saturates at zero if the true result would be negative
-        Natural& operator*=(const Natural& y) { return *this = *this * y; }
+        Natural& operator*=(const Natural& y);
         Natural& operator/=(const Natural& y) { return *this = divide(y).first; }
         Natural& operator%=(const Natural& y) { return *this = divide(y).second; }
         Natural& operator&=(const Natural& y);
@@ -66,19 +255,35 @@ namespace RS {
         template <std::unsigned_integral T> Natural& operator|=(T y) { return *this |= Natural{y}; }
         template <std::unsigned_integral T> Natural& operator^=(T y) { return *this ^= Natural{y}; }
 
-        friend Natural operator+(const Natural& x, const Natural& y) { auto z = x; z += y; return z; }
-        friend Natural operator-(const Natural& x, const Natural& y) { auto z = x; z -= y; return z; }
+        // The left operand is taken by value so a temporary's buffer is reused;
+        // the commutative operators also reuse a temporary right operand
+
+        friend Natural operator+(Natural x, const Natural& y) { x += y; return x; }
+        friend Natural operator+(const Natural& x, Natural&& y) { y += x; return std::move(y); }
+        friend Natural operator-(Natural x, const Natural& y) { x -= y; return x; }
         friend Natural operator*(const Natural& x, const Natural& y);
+        friend Natural operator*(Natural&& x, const Natural& y) { x *= y; return std::move(x); }
+        friend Natural operator*(const Natural& x, Natural&& y) { y *= x; return std::move(y); }
+        friend Natural operator*(Natural&& x, Natural&& y) { x *= y; return std::move(x); }
         friend Natural operator/(const Natural& x, const Natural& y) { return x.divide(y).first; }
         friend Natural operator%(const Natural& x, const Natural& y) { return x.divide(y).second; }
-        friend Natural operator&(const Natural& x, const Natural& y) { auto z = x; z &= y; return z; }
-        friend Natural operator|(const Natural& x, const Natural& y) { auto z = x; z |= y; return z; }
-        friend Natural operator^(const Natural& x, const Natural& y) { auto z = x; z ^= y; return z; }
-        friend Natural operator<<(const Natural& x, int y) { auto z = x; z <<= y; return z; }
-        friend Natural operator>>(const Natural& x, int y) { auto z = x; z >>= y; return z; }
+        friend Natural operator&(Natural x, const Natural& y) { x &= y; return x; }
+        friend Natural operator&(const Natural& x, Natural&& y) { y &= x; return std::move(y); }
+        friend Natural operator|(Natural x, const Natural& y) { x |= y; return x; }
+        friend Natural operator|(const Natural& x, Natural&& y) { y |= x; return std::move(y); }
+        friend Natural operator^(Natural x, const Natural& y) { x ^= y; return x; }
+        friend Natural operator^(const Natural& x, Natural&& y) { y ^= x; return std::move(y); }
+        friend Natural operator<<(Natural x, int y) { x <<= y; return x; }
+        friend Natural operator>>(Natural x, int y) { x >>= y; return x; }
         friend bool operator==(const Natural& x, const Natural& y) noexcept;
         friend std::strong_ordering operator<=>(const Natural& x, const Natural& y) noexcept;
+        friend Natural gcd(const Natural& x, const Natural& y);
+        friend Natural lcm(const Natural& x, const Natural& y);
 
+        Natural& add_mul(const Natural& x, const Natural& y); // *this += x * y
+        Natural& sub_mul(const Natural& x, const Natural& y); // *this -= x * y, saturating
+        Natural& mul_add(const Natural& y, const Natural& z); // *this = *this * y + z
+        Natural& mul_sub(const Natural& y, const Natural& z); // *this = *this * y - z, saturating
         std::pair<Natural, Natural> divide(const Natural& y) const;
         std::size_t bits() const noexcept;
         bool get_bit(std::size_t i) const noexcept;
@@ -97,20 +302,68 @@ namespace RS {
 
         static std::optional<Natural> parse(std::string_view str, unsigned base = 10);
 
+        // Multiplication algorithm thresholds, in words
+        static inline std::atomic<std::size_t> karatsuba_threshold {32};
+        static inline std::atomic<std::size_t> toom3_threshold {160};
+
     private:
 
         friend class Integer;
 
-        using word = std::uint32_t;
-        using double_word = std::uint64_t;
+        using word = Detail::MpWord;
+        using double_word = Detail::MpDoubleWord;
+        using signed_double_word = Detail::MpSignedDoubleWord;
 
         static constexpr auto word_bits_size = 8uz * sizeof(word);
         static constexpr auto word_bits_int = static_cast<int>(word_bits_size);
         static constexpr auto word_mask = ~ word{0};
+        static constexpr std::size_t radix_threshold = 32; // Words
+        static constexpr std::size_t newton_threshold = 1024; // Words
+
+        // The tuning thresholds may be changed by another thread, so each
+        // use reads them once
+
+        static std::size_t karatsuba_cutoff() noexcept {
+            return std::max(karatsuba_threshold.load(std::memory_order::relaxed), 4uz);
+        }
+
+        static std::size_t toom3_cutoff() noexcept {
+            return std::max(toom3_threshold.load(std::memory_order::relaxed), 9uz);
+        }
+
+        // Values up to 256 bits are stored without a heap allocation
+
+        static constexpr std::size_t local_words = 32 / sizeof(word);
 
-        std::vector<word> words_; // Little endian order
+        Detail::InlineVector<word, local_words> words_; // Little endian order
 
+        void add_product(const Natural& x, const Natural& y);
+        void add_shifted(const Natural& y, std::size_t offset);
+        void append_digits(std::string& out, unsigned base, std::size_t digits,
+            const std::vector<Natural>& powers, const std::vector<Natural>& inverses,
+            std::size_t level) const;
+        std::pair<Natural, Natural> divide_reciprocal(const Natural& y, const Natural& r) const;
+        word divide_word(word y) noexcept;
+        word extract_bits(std::size_t pos) const noexcept;
+        void multiply_add_word(word m, word a);
+        void multiply_in_place(const Natural& y);
         void normalize() noexcept;
+        Natural slice(std::size_t pos, std::size_t len) const;
+        void subtract_from(const Natural& y);
+        bool subtract_product(const Natural& x, const Natural& y);
+        std::size_t trailing_zeros() const noexcept;
+
+        static void combine(Natural& z, const Natural& x, signed_double_word a,
+            const Natural& y, signed_double_word b);
+        static Natural from_digits(std::string_view digits, unsigned base,
+            const std::vector<Natural>& powers, std::size_t level);
+        static std::pair<word, std::size_t> radix_chunk(unsigned base) noexcept;
+        static Natural reciprocal(const Natural& y);
+
+        static Natural multiply(const Natural& x, const Natural& y);
+        static Natural multiply_schoolbook(const Natural& x, const Natural& y);
+        static Natural multiply_karatsuba(const Natural& x, const Natural& y);
+        static Natural multiply_toom3(const Natural& x, const Natural& y);
 
     };
 
@@ -129,11 +382,13 @@ namespace RS {
     }
 
     inline Natural::Natural(std::initializer_list<std::uint64_t> list):
-    words_(2 * list.size()) {
+    words_(list.size() * sizeof(std::uint64_t) / sizeof(word)) {
+        static constexpr auto words_per_item = sizeof(std::uint64_t) / sizeof(word);
         auto j = words_.size();
         for (auto i: list) {
-            words_[--j] = static_cast<word>(i >> word_bits_int);
-            words_[--j] = static_cast<word>(i);
+            for (auto k = words_per_item - 1; k != npos; --k) {
+                words_[--j] = static_cast<word>(i >> (k * word_bits_size));
+            }
         }
         normalize();
     }
@@ -205,7 +460,14 @@ namespace RS {
                 borrow = --words_[i] == word_mask;
             }
 
-            normalize();
+            // A borrow out of the top word means y was bigger, which can
+            // happen when both have the same number of words
+
+            if (borrow) {
+                words_.clear();
+            } else {
+                normalize();
+            }
 
         } else {
 
@@ -234,10 +496,9 @@ namespace RS {
 
     inline Natural& Natural::operator|=(const Natural& y) {
 
-        auto common = std::min(words_.size(), y.words_.size());
         words_.resize(std::max(words_.size(), y.words_.size()));
 
-        for (auto i = 0uz; i < common; ++i) {
+        for (auto i = 0uz; i < y.words_.size(); ++i) {
             words_[i] |= y.words_[i];
         }
 
@@ -247,10 +508,9 @@ namespace RS {
 
     inline Natural& Natural::operator^=(const Natural& y) {
 
-        auto common = std::min(words_.size(), y.words_.size());
         words_.resize(std::max(words_.size(), y.words_.size()));
 
-        for (auto i = 0uz; i < common; ++i) {
+        for (auto i = 0uz; i < y.words_.size(); ++i) {
             words_[i] ^= y.words_[i];
         }
 
@@ -325,57 +585,67 @@ namespace RS {
 
     }
 
-    inline Natural operator*(const Natural& x, const Natural& y) {
+    inline Natural& Natural::operator*=(const Natural& y) {
+        multiply_in_place(y);
+        return *this;
+    }
 
-        Natural z;
+    inline Natural& Natural::add_mul(const Natural& x, const Natural& y) {
+        add_product(x, y);
+        return *this;
+    }
 
-        if (! x || ! y) {
-            return z;
+    inline Natural& Natural::sub_mul(const Natural& x, const Natural& y) {
+        if (subtract_product(x, y)) {
+            words_.clear();
         }
+        return *this;
+    }
 
-        auto m = x.words_.size();
-        auto n = y.words_.size();
-        z.words_.assign(m + n, 0);
-        Natural::double_word carry = 0;
-
-        for (auto k = 0uz; k <= m + n - 2; ++k) {
-
-            carry += z.words_[k];
-            z.words_[k] = static_cast<Natural::word>(carry);
-            carry >>= Natural::word_bits_int;
-            auto i_min = k < n ? 0uz : k - n + 1;
-            auto i_max = k < m ? k : m - 1;
-
-            for (auto i = i_min; i <= i_max; ++i) {
-                Natural::double_word p = x.words_[i];
-                p *= y.words_[k - i];
-                p += z.words_[k];
-                z.words_[k] = static_cast<Natural::word>(p);
-                carry += p >> Natural::word_bits_int;
-            }
-
+    inline Natural& Natural::mul_add(const Natural& y, const Natural& z) {
+        if (&z == this) {
+            auto z_copy = z;
+            return mul_add(y, z_copy);
         }
+        multiply_in_place(y);
+        return *this += z;
+    }
 
-        z.words_[m + n - 1] = static_cast<Natural::word>(carry);
-        z.normalize();
-
-        return z;
+    inline Natural& Natural::mul_sub(const Natural& y, const Natural& z) {
+        if (&z == this) {
+            auto z_copy = z;
+            return mul_sub(y, z_copy);
+        }
+        multiply_in_place(y);
+        return *this -= z;
+    }
 
+    inline Natural operator*(const Natural& x, const Natural& y) {
+        if (! x || ! y) {
+            return {};
+        } else if (x.words_.size() >= y.words_.size()) {
+            return Natural::multiply(x, y);
+        } else {
+            return Natural::multiply(y, x);
+        }
     }
 
     template <std::unsigned_integral T>
-    Natural operator+(const Natural& x, T y) {
-        return x + Natural{y};
+    Natural operator+(Natural x, T y) {
+        x += y;
+        return x;
     }
 
     template <std::unsigned_integral T>
-    Natural operator-(const Natural& x, T y) {
-        return x - Natural{y};
+    Natural operator-(Natural x, T y) {
+        x -= y;
+        return x;
     }
 
     template <std::unsigned_integral T>
-    Natural operator*(const Natural& x, T y) {
-        return x * Natural{y};
+    Natural operator*(Natural x, T y) {
+        x *= y;
+        return x;
     }
 
     template <std::unsigned_integral T>
@@ -389,23 +659,27 @@ namespace RS {
     }
 
     template <std::unsigned_integral T>
-    Natural operator&(const Natural& x, T y) {
-        return x & Natural{y};
+    Natural operator&(Natural x, T y) {
+        x &= y;
+        return x;
     }
 
     template <std::unsigned_integral T>
-    Natural operator|(const Natural& x, T y) {
-        return x | Natural{y};
+    Natural operator|(Natural x, T y) {
+        x |= y;
+        return x;
     }
 
     template <std::unsigned_integral T>
-    Natural operator^(const Natural& x, T y) {
-        return x ^ Natural{y};
+    Natural operator^(Natural x, T y) {
+        x ^= y;
+        return x;
     }
 
     template <std::unsigned_integral T>
-    Natural operator+(T x, const Natural& y) {
-        return Natural{x} + y;
+    Natural operator+(T x, Natural y) {
+        y += x;
+        return y;
     }
 
     template <std::unsigned_integral T>
@@ -414,8 +688,9 @@ namespace RS {
     }
 
     template <std::unsigned_integral T>
-    Natural operator*(T x, const Natural& y) {
-        return Natural{x} * y;
+    Natural operator*(T x, Natural y) {
+        y *= x;
+        return y;
     }
 
     template <std::unsigned_integral T>
@@ -429,18 +704,21 @@ namespace RS {
     }
 
     template <std::unsigned_integral T>
-    Natural operator&(T x, const Natural& y) {
-        return Natural{x} & y;
+    Natural operator&(T x, Natural y) {
+        y &= x;
+        return y;
     }
 
     template <std::unsigned_integral T>
-    Natural operator|(T x, const Natural& y) {
-        return Natural{x} | y;
+    Natural operator|(T x, Natural y) {
+        y |= x;
+        return y;
     }
 
     template <std::unsigned_integral T>
-    Natural operator^(T x, const Natural& y) {
-        return Natural{x} ^ y;
+    Natural operator^(T x, Natural y) {
+        y ^= x;
+        return y;
     }
 
     inline bool operator==(const Natural& x, const Natural& y) noexcept {
@@ -500,16 +778,109 @@ namespace RS {
         return x <=> Natural{y};
     }
 
+    inline Natural gcd(const Natural& x, const Natural& y) {
+
+        // Common factors of two are removed first. Lehmer's algorithm (Knuth
+        // 4.5.2 algorithm L) then runs Euclid's algorithm on the leading bits
+        // of both values, applying several steps at once through a matrix
+        // of single word cofactors, until the smaller value fits in a word.
+
+        using signed_double_word = Natural::signed_double_word;
+
+        static constexpr auto digit_bits = Natural::word_bits_size - 1;
+
+        if (! x) {
+            return y;
+        } else if (! y) {
+            return x;
+        }
+
+        auto x_zeros = x.trailing_zeros();
+        auto y_zeros = y.trailing_zeros();
+        auto u = x >> static_cast<int>(x_zeros);
+        auto v = y >> static_cast<int>(y_zeros);
+        Natural t, w;
+
+        if (u < v) {
+            std::swap(u, v);
+        }
+
+        while (v.words_.size() > 1) {
+
+            auto pos = u.bits() - digit_bits;
+            signed_double_word u_digit = u.extract_bits(pos);
+            signed_double_word v_digit = v.extract_bits(pos);
+            signed_double_word a = 1, b = 0, c = 0, d = 1;
+
+            for (;;) {
+                auto num1 = u_digit + a;
+                auto num2 = u_digit + b;
+                auto den1 = v_digit + c;
+                auto den2 = v_digit + d;
+                if (num1 < 0 || num2 < 0 || den1 <= 0 || den2 <= 0) {
+                    break;
+                }
+                auto q = num1 / den1;
+                if (q != num2 / den2) {
+                    break;
+                }
+                auto s = a - q * c;
+                a = c;
+                c = s;
+                s = b - q * d;
+                b = d;
+                d = s;
+                s = u_digit - q * v_digit;
+                u_digit = v_digit;
+                v_digit = s;
+            }
+
+            if (b == 0) {
+                t = u % v;
+                u = std::move(v);
+                v = std::move(t);
+            } else {
+                Natural::combine(t, u, a, v, b);
+                Natural::combine(w, u, c, v, d);
+                std::swap(u, t);
+                std::swap(v, w);
+                if (u < v) {
+                    std::swap(u, v);
+                }
+            }
+
+        }
+
+        if (v) {
+            auto r = u.divide_word(v.words_[0]);
+            u = std::gcd(v.words_[0], r);
+        }
+
+        u <<= static_cast<int>(std::min(x_zeros, y_zeros));
+
+        return u;
+
+    }
+
+    inline Natural lcm(const Natural& x, const Natural& y) {
+        if (! x || ! y) {
+            return {};
+        }
+        auto z = x / gcd(x, y);
+        z *= y;
+        return z;
+    }
+
     inline std::pair<Natural, Natural> Natural::divide(const Natural& y) const {
 
-        if (words_.empty()) {
+        if (y.words_.empty()) {
+            throw std::domain_error("Division by zero");
+        } else if (words_.empty()) {
             return {};
-        } else if (words_.size() == 1 && y.words_.size() == 1) {
-            auto a = words_[0];
-            auto b = y.words_[0];
-            auto q = a / b;
-            auto r = a % b;
-            return {q, r};
+        } else if (y.words_.size() == 1) {
+            auto q = *this;
+            auto r = q.divide_word(y.words_[0]);
+            return {std::move(q), r};
         }
 
         auto cmp = *this <=> y;
@@ -520,32 +891,81 @@ namespace RS {
             return {{1u}, {}};
         }
 
+        // Knuth's Algorithm D (TAOCP 4.3.1), with the multiply-subtract step
+        // from Hacker's Delight. Normalize so the divisor's top bit is set.
+
+        auto shift = std::countl_zero(y.words_.back());
+        auto u = *this << shift;
+        auto v = y << shift;
+        auto n = v.words_.size();
+        auto m = words_.size() - n;
+        u.words_.resize(words_.size() + 1, 0);
+
         Natural q;
-        Natural r{*this};
+        q.words_.resize(m + 1, 0);
+        auto v1 = double_word{v.words_[n - 1]};
+        auto v2 = double_word{v.words_[n - 2]};
 
-        auto shift = static_cast<int>(bits() - y.bits());
-        auto r_sub = y << shift;
+        for (auto j = m; j != npos; --j) {
 
-        if (r_sub > *this) {
-            --shift;
-            r_sub >>= 1;
-        }
+            // Estimate the quotient digit; this is at most 2 too big
+
+            auto num = (double_word{u.words_[j + n]} << word_bits_int) + u.words_[j + n - 1];
+            auto qhat = num / v1;
+            auto rhat = num % v1;
+
+            while (qhat > word_mask || qhat * v2 > (rhat << word_bits_int) + u.words_[j + n - 2]) {
+                --qhat;
+                rhat += v1;
+                if (rhat > word_mask) {
+                    break;
+                }
+            }
 
-        auto q_add = Natural{1} << shift;
+            // Multiply and subtract
 
-        while (q_add) {
+            signed_double_word borrow = 0;
+            signed_double_word t = 0;
 
-            if (r >= r_sub) {
-                q += q_add;
-                r -= r_sub;
+            for (auto i = 0uz; i < n; ++i) {
+                auto p = qhat * v.words_[i];
+                t = signed_double_word{u.words_[i + j]} - borrow - static_cast<signed_double_word>(p & word_mask);
+                u.words_[i + j] = static_cast<word>(t);
+                borrow = static_cast<signed_double_word>(p >> word_bits_int) - (t >> word_bits_int);
             }
 
-            r_sub >>= 1;
-            q_add >>= 1;
+            t = signed_double_word{u.words_[j + n]} - borrow;
+            u.words_[j + n] = static_cast<word>(t);
+
+            // If the result went negative the estimate was one too big, add
+            // the divisor back in
+
+            if (t < 0) {
+
+                --qhat;
+                double_word carry = 0;
+
+                for (auto i = 0uz; i < n; ++i) {
+                    carry += u.words_[i + j];
+                    carry += v.words_[i];
+                    u.words_[i + j] = static_cast<word>(carry);
+                    carry >>= word_bits_int;
+                }
+
+                u.words_[j + n] += static_cast<word>(carry);
+
+            }
+
+            q.words_[j] = static_cast<word>(qhat);
 
         }
 
-        return {q, r};
+        q.normalize();
+        u.words_.resize(n);
+        u.normalize();
+        u >>= shift;
+
+        return {std::move(q), std::move(u)};
 
     }
 
@@ -604,7 +1024,7 @@ namespace RS {
 
     inline double Natural::as_double() const noexcept {
 
-        if (words_.size() <= 2) {
+        if (bits() <= 64) {
 
             return static_cast<double>(unchecked_cast<std::uint64_t>());
 
@@ -675,36 +1095,65 @@ namespace RS {
             throw std::out_of_range(std::format("Invalid number base: {}", base));
         }
 
-        auto num = *this;
         std::string out;
 
         if (std::has_single_bit(base)) {
 
-            auto shift = std::bit_width(base) - 1;
-            auto mask = (Natural{1} << shift) - 1u;
+            auto shift = static_cast<int>(std::bit_width(base)) - 1;
+            auto mask = double_word{base - 1};
+            double_word acc = 0;
+            auto acc_bits = 0;
+            auto i = 0uz;
 
-            while (num || out.size() < digits) {
-                auto remainder = static_cast<int>(num & mask);
+            while (i < words_.size() || acc_bits > 0) {
+                if (acc_bits < shift && i < words_.size()) {
+                    acc |= double_word{words_[i++]} << acc_bits;
+                    acc_bits += word_bits_int;
+                }
+                auto remainder = static_cast<int>(acc & mask);
                 auto code = remainder + (remainder < 10 ? '0' : 'a' - 10);
                 out += static_cast<char>(code);
-                num >>= shift;
+                acc >>= shift;
+                acc_bits -= shift;
+            }
+
+            while (! out.empty() && out.back() == '0') {
+                out.pop_back();
+            }
+
+            if (out.size() < digits) {
+                out.resize(digits, '0');
             }
 
+            std::ranges::reverse(out);
+
+        } else if (words_.size() < radix_threshold) {
+
+            append_digits(out, base, digits, {}, {}, 0);
+
         } else {
 
-            Natural nat_base{base};
+            // Precompute powers of the base: powers[k] = chunk^(2^k). The
+            // large powers also get a reciprocal, so that splitting on them
+            // costs a few multiplications instead of a quadratic division.
 
-            while (num || out.size() < digits) {
-                auto [quo,rem] = num.divide(nat_base);
-                auto remainder = static_cast<int>(rem);
-                auto code = remainder + (remainder < 10 ? '0' : 'a' - 10);
-                out += static_cast<char>(code);
-                num = std::move(quo);
+            std::vector<Natural> powers{radix_chunk(base).first};
+
+            while (2 * powers.back().words_.size() <= words_.size() + 1) {
+                powers.push_back(powers.back() * powers.back());
             }
 
-        }
+            std::vector<Natural> inverses(powers.size());
+
+            for (auto i = 0uz; i < powers.size(); ++i) {
+                if (powers[i].words_.size() >= newton_threshold) {
+                    inverses[i] = reciprocal(powers[i]);
+                }
+            }
+
+            append_digits(out, base, digits, powers, inverses, powers.size());
 
-        std::ranges::reverse(out);
+        }
 
         return out;
 
@@ -733,8 +1182,10 @@ namespace RS {
             return {};
         }
 
-        Natural factor{base};
-        Natural value;
+        // First pass: validate and reduce to a string of digit values
+
+        std::string values;
+        values.reserve(body.size());
         unsigned digit{};
 
         for (auto c: body) {
@@ -752,10 +1203,301 @@ namespace RS {
             if (digit >= base) {
                 return {};
             }
-            value = value * factor + digit;
+            values += static_cast<char>(digit);
         }
 
-        return value;
+        if (std::has_single_bit(base)) {
+
+            // Power of 2 base: pack bits directly, starting from the least
+            // significant digit
+
+            auto shift = static_cast<int>(std::bit_width(base)) - 1;
+            Natural value;
+            double_word acc = 0;
+            auto acc_bits = 0;
+
+            for (auto i = values.size() - 1; i != npos; --i) {
+                acc |= double_word{static_cast<unsigned char>(values[i])} << acc_bits;
+                acc_bits += shift;
+                if (acc_bits >= word_bits_int) {
+                    value.words_.push_back(static_cast<word>(acc));
+                    acc >>= word_bits_int;
+                    acc_bits -= word_bits_int;
+                }
+            }
+
+            value.words_.push_back(static_cast<word>(acc));
+            value.normalize();
+
+            return value;
+
+        }
+
+        auto chunk_digits = radix_chunk(base).second;
+        std::vector<Natural> powers;
+
+        if (values.size() > radix_threshold * chunk_digits) {
+            powers.push_back(radix_chunk(base).first);
+            while ((chunk_digits << powers.size()) < values.size()) {
+                powers.push_back(powers.back() * powers.back());
+            }
+        }
+
+        return from_digits(values, base, powers, powers.size());
+
+    }
+
+    inline void Natural::add_product(const Natural& x, const Natural& y) {
+
+        // Equivalent to *this += x * y. Below the Karatsuba threshold, each
+        // row of the schoolbook product is accumulated directly into this
+        // object's buffer, so no temporary is needed.
+
+        if (! x || ! y) {
+            return;
+        }
+
+        auto m = x.words_.size();
+        auto n = y.words_.size();
+
+        if (&x == this || &y == this || std::min(m, n) >= karatsuba_cutoff()) {
+            add_shifted(x * y, 0);
+            return;
+        }
+
+        words_.resize(std::max(words_.size(), m + n) + 1, 0);
+
+        for (auto i = 0uz; i < m; ++i) {
+
+            double_word a = x.words_[i];
+            double_word carry = 0;
+
+            for (auto j = 0uz; j < n; ++j) {
+                carry += a * y.words_[j] + words_[i + j];
+                words_[i + j] = static_cast<word>(carry);
+                carry >>= word_bits_int;
+            }
+
+            for (auto k = i + n; carry; ++k) {
+                carry += words_[k];
+                words_[k] = static_cast<word>(carry);
+                carry >>= word_bits_int;
+            }
+
+        }
+
+        normalize();
+
+    }
+
+    inline void Natural::add_shifted(const Natural& y, std::size_t offset) {
+
+        // Equivalent to *this += y << (offset * word_bits_int)
+
+        if (! y) {
+            return;
+        }
+
+        words_.resize(std::max(words_.size(), y.words_.size() + offset), 0);
+        double_word sum = 0;
+        auto i = offset;
+
+        for (auto w: y.words_) {
+            sum += words_[i];
+            sum += w;
+            words_[i++] = static_cast<word>(sum);
+            sum >>= word_bits_int;
+        }
+
+        for (; sum && i < words_.size(); ++i) {
+            sum += words_[i];
+            words_[i] = static_cast<word>(sum);
+            sum >>= word_bits_int;
+        }
+
+        if (sum) {
+            words_.push_back(static_cast<word>(sum));
+        }
+
+    }
+
+    inline void Natural::append_digits(std::string& out, unsigned base, std::size_t digits,
+            const std::vector<Natural>& powers, const std::vector<Natural>& inverses,
+            std::size_t level) const {
+
+        // Divide and conquer radix conversion. Split on the largest usable
+        // power of the base that does not exceed this value; the remainder
+        // supplies a fixed number of low order digits. Small values are
+        // converted one word-sized chunk of digits at a time. The value is
+        // always less than the square of the power it is split on, which
+        // is what divide_reciprocal() requires.
+
+        auto k = level;
+
+        while (k > 0 && powers[k - 1] > *this) {
+            --k;
+        }
+
+        auto [chunk, chunk_digits] = radix_chunk(base);
+
+        if (k == 0 || words_.size() < radix_threshold) {
+
+            auto num = *this;
+            auto start = out.size();
+
+            while (num) {
+                auto remainder = num.divide_word(chunk);
+                for (auto i = 0uz; i < chunk_digits; ++i) {
+                    auto d = static_cast<int>(remainder % base);
+                    auto code = d + (d < 10 ? '0' : 'a' - 10);
+                    out += static_cast<char>(code);
+                    remainder /= base;
+                }
+            }
+
+            while (out.size() > start && out.back() == '0') {
+                out.pop_back();
+            }
+
+            if (out.size() - start < digits) {
+                out.resize(start + digits, '0');
+            }
+
+            std::reverse(out.begin() + static_cast<std::ptrdiff_t>(start), out.end());
+
+        } else {
+
+            auto [quo,rem] = inverses[k - 1] ? divide_reciprocal(powers[k - 1], inverses[k - 1]) : divide(powers[k - 1]);
+            auto low_digits = chunk_digits << (k - 1);
+            quo.append_digits(out, base, digits > low_digits ? digits - low_digits : 0, powers, inverses, k - 1);
+            rem.append_digits(out, base, low_digits, powers, inverses, k - 1);
+
+        }
+
+    }
+
+    inline std::pair<Natural, Natural> Natural::divide_reciprocal(const Natural& y, const Natural& r) const {
+
+        // Requires *this < y^2 and r = reciprocal(y). Only the top n+1
+        // words of the dividend are needed for the quotient estimate, which
+        // is never too big, and at most 3 too small.
+
+        auto n = y.words_.size();
+        auto low_bits = static_cast<int>((n - 1) * word_bits_size);
+        auto shift = static_cast<int>((n + 1) * word_bits_size);
+        auto q = ((*this >> low_bits) * r) >> shift;
+        auto rem = *this - q * y;
+
+        while (rem >= y) {
+            rem -= y;
+            ++q;
+        }
+
+        return {std::move(q), std::move(rem)};
+
+    }
+
+    inline Natural::word Natural::divide_word(word y) noexcept {
+
+        // Divides in place and returns the remainder, UB if y=0
+
+        double_word r = 0;
+
+        for (auto i = words_.size() - 1; i != npos; --i) {
+            r = (r << word_bits_int) + words_[i];
+            words_[i] = static_cast<word>(r / y);
+            r %= y;
+        }
+
+        normalize();
+
+        return static_cast<word>(r);
+
+    }
+
+    inline Natural::word Natural::extract_bits(std::size_t pos) const noexcept {
+
+        // Returns the word_bits-1 bits starting at bit pos
+
+        auto i = pos / word_bits_size;
+        auto j = static_cast<int>(pos % word_bits_size);
+        word w = 0;
+
+        if (i < words_.size()) {
+            w = words_[i] >> j;
+            if (j > 0 && i + 1 < words_.size()) {
+                w |= words_[i + 1] << (word_bits_int - j);
+            }
+        }
+
+        return w & (word_mask >> 1);
+
+    }
+
+    inline void Natural::multiply_add_word(word m, word a) {
+
+        // Equivalent to *this = *this * m + a
+
+        double_word carry = a;
+
+        for (auto& w: words_) {
+            carry += double_word{w} * m;
+            w = static_cast<word>(carry);
+            carry >>= word_bits_int;
+        }
+
+        if (carry) {
+            words_.push_back(static_cast<word>(carry));
+        }
+
+    }
+
+    inline void Natural::multiply_in_place(const Natural& y) {
+
+        // Below the Karatsuba threshold, the product overwrites this object's
+        // words from the top down: row i only touches words at or above i,
+        // and the multiplicand words above i have already been consumed.
+
+        if (! *this) {
+            return;
+        }
+
+        if (! y) {
+            words_.clear();
+            return;
+        }
+
+        auto m = words_.size();
+        auto n = y.words_.size();
+
+        if (&y == this || std::min(m, n) >= karatsuba_cutoff()) {
+            *this = *this * y;
+            return;
+        }
+
+        words_.resize(m + n, 0);
+
+        for (auto i = m - 1; i != npos; --i) {
+
+            double_word a = words_[i];
+            double_word carry = 0;
+            words_[i] = 0;
+
+            for (auto j = 0uz; j < n; ++j) {
+                carry += a * y.words_[j] + words_[i + j];
+                words_[i + j] = static_cast<word>(carry);
+                carry >>= word_bits_int;
+            }
+
+            for (auto k = i + n; carry; ++k) {
+                carry += words_[k];
+                words_[k] = static_cast<word>(carry);
+                carry >>= word_bits_int;
+            }
+
+        }
+
+        normalize();
 
     }
 
@@ -767,6 +1509,356 @@ namespace RS {
         words_.resize(i + 1);
     }
 
+    inline Natural Natural::slice(std::size_t pos, std::size_t len) const {
+
+        // Returns the value formed by words [pos,pos+len)
+
+        Natural z;
+
+        if (pos < words_.size()) {
+            len = std::min(len, words_.size() - pos);
+            auto begin = words_.begin() + static_cast<std::ptrdiff_t>(pos);
+            z.words_.assign(begin, begin + static_cast<std::ptrdiff_t>(len));
+            z.normalize();
+        }
+
+        return z;
+
+    }
+
+    inline void Natural::subtract_from(const Natural& y) {
+
+        // Equivalent to *this = y - *this, requires y >= *this
+
+        words_.resize(y.words_.size(), 0);
+        auto borrow = false;
+
+        for (auto i = 0uz; i < words_.size(); ++i) {
+            auto w = y.words_[i];
+            auto will_borrow = w < words_[i] || (borrow && w == words_[i]);
+            words_[i] = w - words_[i] - static_cast<word>(borrow);
+            borrow = will_borrow;
+        }
+
+        normalize();
+
+    }
+
+    inline bool Natural::subtract_product(const Natural& x, const Natural& y) {
+
+        // Equivalent to *this = abs(*this - x * y), returning true if the
+        // product was the larger. Rows are subtracted in place as in
+        // add_product(); if the result underflows, the buffer is left
+        // holding its complement, which is then negated.
+
+        if (! x || ! y) {
+            return false;
+        }
+
+        auto m = x.words_.size();
+        auto n = y.words_.size();
+
+        if (&x == this || &y == this || std::min(m, n) >= karatsuba_cutoff()) {
+            auto p = x * y;
+            if (*this >= p) {
+                *this -= p;
+                return false;
+            }
+            subtract_from(p);
+            return true;
+        }
+
+        words_.resize(std::max(words_.size(), m + n), 0);
+        auto underflow = false;
+
+        for (auto i = 0uz; i < m; ++i) {
+
+            double_word a = x.words_[i];
+            double_word borrow = 0;
+
+            for (auto j = 0uz; j < n; ++j) {
+                auto p = a * y.words_[j] + borrow;
+                auto low = static_cast<word>(p);
+                borrow = (p >> word_bits_int) + (words_[i + j] < low);
+                words_[i + j] -= low;
+            }
+
+            for (auto k = i + n; borrow; ++k) {
+                if (k == words_.size()) {
+                    underflow = true;
+                    break;
+                }
+                auto b = static_cast<word>(borrow);
+                borrow = words_[k] < b;
+                words_[k] -= b;
+            }
+
+        }
+
+        if (underflow) {
+            auto carry = true;
+            for (auto& w: words_) {
+                w = ~ w + static_cast<word>(carry);
+                carry = carry && w == 0;
+            }
+        }
+
+        normalize();
+
+        return underflow;
+
+    }
+
+    inline std::size_t Natural::trailing_zeros() const noexcept {
+
+        // UB if zero
+
+        auto i = 0uz;
+
+        while (words_[i] == 0) {
+            ++i;
+        }
+
+        return i * word_bits_size + static_cast<std::size_t>(std::countr_zero(words_[i]));
+
+    }
+
+    inline void Natural::combine(Natural& z, const Natural& x, signed_double_word a,
+            const Natural& y, signed_double_word b) {
+
+        // z = a*x + b*y, where a and b do not have the same sign, their
+        // magnitudes fit in a word, and the result is not negative
+
+        if (a < 0 || b > 0) {
+            combine(z, y, b, x, a);
+            return;
+        }
+
+        auto m = static_cast<word>(a);
+        auto n = static_cast<word>(- b);
+        auto size = std::max(x.words_.size(), y.words_.size());
+        z.words_.resize(size + 1);
+        double_word x_carry = 0;
+        double_word y_carry = 0;
+        auto borrow = false;
+
+        for (auto i = 0uz; i < size; ++i) {
+            x_carry += static_cast<double_word>(m) * (i < x.words_.size() ? x.words_[i] : 0);
+            y_carry += static_cast<double_word>(n) * (i < y.words_.size() ? y.words_[i] : 0);
+            auto p = static_cast<word>(x_carry);
+            auto q = static_cast<word>(y_carry);
+            x_carry >>= word_bits_int;
+            y_carry >>= word_bits_int;
+            z.words_[i] = p - q - static_cast<word>(borrow);
+            borrow = p < q || (borrow && p == q);
+        }
+
+        z.words_[size] = static_cast<word>(x_carry) - static_cast<word>(y_carry) - static_cast<word>(borrow);
+        z.normalize();
+
+    }
+
+    inline Natural Natural::from_digits(std::string_view digits, unsigned base,
+            const std::vector<Natural>& powers, std::size_t level) {
+
+        // Inverse of append_digits(). The digits are raw digit values, not
+        // characters.
+
+        auto [chunk, chunk_digits] = radix_chunk(base);
+        auto k = level;
+
+        while (k > 0 && (chunk_digits << (k - 1)) >= digits.size()) {
+            --k;
+        }
+
+        if (k == 0 || digits.size() <= radix_threshold * chunk_digits) {
+
+            Natural value;
+            word acc = 0;
+            word scale = 1;
+
+            for (auto c: digits) {
+                acc = acc * base + static_cast<unsigned char>(c);
+                scale *= base;
+                if (scale == chunk) {
+                    value.multiply_add_word(chunk, acc);
+                    acc = 0;
+                    scale = 1;
+                }
+            }
+
+            if (scale > 1) {
+                value.multiply_add_word(scale, acc);
+            }
+
+            return value;
+
+        }
+
+        auto split = digits.size() - (chunk_digits << (k - 1));
+        auto value = from_digits(digits.substr(0, split), base, powers, k - 1) * powers[k - 1];
+        value += from_digits(digits.substr(split), base, powers, k - 1);
+
+        return value;
+
+    }
+
+    inline std::pair<Natural::word, std::size_t> Natural::radix_chunk(unsigned base) noexcept {
+
+        // Returns the largest power of the base that fits in a word, and
+        // the number of digits it represents
+
+        word chunk = base;
+        auto chunk_digits = 1uz;
+
+        while (chunk <= word_mask / base) {
+            chunk *= base;
+            ++chunk_digits;
+        }
+
+        return {chunk, chunk_digits};
+
+    }
+
+    inline Natural Natural::reciprocal(const Natural& y) {
+
+        // Returns floor(B^2n/y) for an n-word divisor, where B is the word
+        // base. Newton's iteration on a reciprocal of the top half of the
+        // divisor doubles the precision, so the cost is a few
+        // multiplications rather than a quadratic division. Two guard
+        // words keep the result within a few units of the exact value,
+        // which a final correction fixes.
+
+        auto n = y.words_.size();
+        auto shift = static_cast<int>(2 * n * word_bits_size);
+        auto one = Natural{1u} << shift;
+
+        if (n < newton_threshold) {
+            return one.divide(y).first;
+        }
+
+        auto low_bits = static_cast<int>((n / 2 - 2) * word_bits_size);
+        auto x = reciprocal(y >> low_bits) << low_bits;
+        auto yx = y * x;
+
+        if (yx <= one) {
+            x += (x * (one - yx)) >> shift;
+        } else {
+            x -= (x * (yx - one)) >> shift;
+        }
+
+        yx = y * x;
+
+        while (yx > one) {
+            yx -= y;
+            --x;
+        }
+
+        while (one - yx >= y) {
+            yx += y;
+            ++x;
+        }
+
+        return x;
+
+    }
+
+    inline Natural Natural::multiply(const Natural& x, const Natural& y) {
+
+        // Requires x.size >= y.size > 0
+
+        auto m = x.words_.size();
+        auto n = y.words_.size();
+
+        if (n < karatsuba_cutoff()) {
+
+            return multiply_schoolbook(x, y);
+
+        } else if (2 * n <= m) {
+
+            // Unbalanced operands: split x into chunks the size of y
+
+            Natural z;
+
+            for (auto i = 0uz; i < m; i += n) {
+                auto chunk = x.slice(i, n);
+                if (chunk) {
+                    z.add_shifted(chunk * y, i);
+                }
+            }
+
+            return z;
+
+        } else if (n < toom3_cutoff()) {
+
+            return multiply_karatsuba(x, y);
+
+        } else {
+
+            return multiply_toom3(x, y);
+
+        }
+
+    }
+
+    inline Natural Natural::multiply_schoolbook(const Natural& x, const Natural& y) {
+
+        Natural z;
+        auto m = x.words_.size();
+        auto n = y.words_.size();
+        z.words_.assign(m + n, 0);
+        double_word carry = 0;
+
+        for (auto k = 0uz; k <= m + n - 2; ++k) {
+
+            carry += z.words_[k];
+            z.words_[k] = static_cast<word>(carry);
+            carry >>= word_bits_int;
+            auto i_min = k < n ? 0uz : k - n + 1;
+            auto i_max = k < m ? k : m - 1;
+
+            for (auto i = i_min; i <= i_max; ++i) {
+                double_word p = x.words_[i];
+                p *= y.words_[k - i];
+                p += z.words_[k];
+                z.words_[k] = static_cast<word>(p);
+                carry += p >> word_bits_int;
+            }
+
+        }
+
+        z.words_[m + n - 1] = static_cast<word>(carry);
+        z.normalize();
+
+        return z;
+
+    }
+
+    inline Natural Natural::multiply_karatsuba(const Natural& x, const Natural& y) {
+
+        // x = x1*B+x0, y = y1*B+y0
+        // x*y = z2*B^2 + z1*B + z0
+        // z0 = x0*y0, z2 = x1*y1, z1 = (x0+x1)*(y0+y1)-z0-z2
+
+        auto k = (x.words_.size() + 1) / 2;
+        auto x0 = x.slice(0, k);
+        auto x1 = x.slice(k, npos);
+        auto y0 = y.slice(0, k);
+        auto y1 = y.slice(k, npos);
+        auto z0 = x0 * y0;
+        auto z2 = x1 * y1;
+        x0 += x1;
+        y0 += y1;
+        auto z1 = x0 * y0;
+        z1 -= z0;
+        z1 -= z2;
+        z0.add_shifted(z1, k);
+        z0.add_shifted(z2, 2 * k);
+
+        return z0;
+
+    }
+
     // Signed integer class
 
     class Integer {
@@ -781,14 +1873,15 @@ namespace RS {
         explicit operator bool() const noexcept { return static_cast<bool>(mag_); }
         bool operator!() const noexcept { return ! mag_; }
         Integer operator+() const { return *this; }
-        Integer operator-() const;
+        Integer operator-() const&;
+        Integer operator-() &&;
         Integer& operator++() { return *this += 1; }
         Integer operator++(int) { auto x = *this; ++*this; return x; }
         Integer& operator--() { return *this -= 1; }
         Integer operator--(int) { auto x = *this; ++*this; return x; }
-        Integer& operator+=(const Integer& y);
-        Integer& operator-=(const Integer& y) { return *this += - y; }
-        Integer& operator*=(const Integer& y) { return *this = *this * y; }
+        Integer& operator+=(const Integer& y) { add_signed(y.mag_, y.sign_); return *this; }
+        Integer& operator-=(const Integer& y) { add_signed(y.mag_, ! y.sign_); return *this; }
+        Integer& operator*=(const Integer& y);
         Integer& operator/=(const Integer& y) { return *this = divide(y).first; }
         Integer& operator%=(const Integer& y) { return *this = divide(y).second; }
 
@@ -798,14 +1891,24 @@ namespace RS {
         template <std::signed_integral T> Integer& operator/=(T y) { return *this /= Integer{y}; }
         template <std::signed_integral T> Integer& operator%=(T y) { return *this %= Integer{y}; }
 
-        friend Integer operator+(const Integer& x, const Integer& y) { auto z = x; z += y; return z; }
-        friend Integer operator-(const Integer& x, const Integer& y) { auto z = x; z -= y; return z; }
+        friend Integer operator+(Integer x, const Integer& y) { x += y; return x; }
+        friend Integer operator+(const Integer& x, Integer&& y) { y += x; return std::move(y); }
+        friend Integer operator-(Integer x, const Integer& y) { x -= y; return x; }
         friend Integer operator*(const Integer& x, const Integer& y);
+        friend Integer operator*(Integer&& x, const Integer& y) { x *= y; return std::move(x); }
+        friend Integer operator*(const Integer& x, Integer&& y) { y *= x; return std::move(y); }
+        friend Integer operator*(Integer&& x, Integer&& y) { x *= y; return std::move(x); }
         friend Integer operator/(const Integer& x, const Integer& y) { return x.divide(y).first; }
         friend Integer operator%(const Integer& x, const Integer& y) { return x.divide(y).second; }
         friend bool operator==(const Integer& x, const Integer& y) noexcept { return x.sign_ == y.sign_ && x.mag_ == y.mag_; }
         friend std::strong_ordering operator<=>(const Integer& x, const Integer& y) noexcept;
+        friend Integer gcd(const Integer& x, const Integer& y);
+        friend Integer lcm(const Integer& x, const Integer& y);
 
+        Integer& add_mul(const Integer& x, const Integer& y); // *this += x * y
+        Integer& sub_mul(const Integer& x, const Integer& y); // *this -= x * y
+        Integer& mul_add(const Integer& y, const Integer& z); // *this = *this * y + z
+        Integer& mul_sub(const Integer& y, const Integer& z); // *this = *this * y - z
         std::pair<Integer, Integer> divide(const Integer& y) const;
         double as_double() const noexcept;
         explicit operator double() const noexcept { return as_double(); }
@@ -824,9 +1927,14 @@ namespace RS {
 
     private:
 
+        friend class Natural;
+
         Natural mag_;
         bool sign_ = false; // true = negative
 
+        void add_product(const Integer& x, const Integer& y, bool negate);
+        void add_signed(const Natural& y, bool negative);
+
     };
 
     template <std::integral T>
@@ -854,7 +1962,7 @@ namespace RS {
         *this = std::move(*opt);
     }
 
-    inline Integer Integer::operator-() const {
+    inline Integer Integer::operator-() const& {
         Integer z = *this;
         if (z) {
             z.sign_ = ! z.sign_;
@@ -862,39 +1970,98 @@ namespace RS {
         return z;
     }
 
-    inline Integer& Integer::operator+=(const Integer& y) {
+    inline Integer Integer::operator-() && {
+        if (mag_) {
+            sign_ = ! sign_;
+        }
+        return std::move(*this);
+    }
+
+    inline Integer& Integer::operator*=(const Integer& y) {
+        auto negative = sign_ != y.sign_;
+        mag_ *= y.mag_;
+        sign_ = negative && static_cast<bool>(mag_);
+        return *this;
+    }
+
+    inline Integer& Integer::add_mul(const Integer& x, const Integer& y) {
+        add_product(x, y, false);
+        return *this;
+    }
 
-        if (! y.mag_) {
+    inline Integer& Integer::sub_mul(const Integer& x, const Integer& y) {
+        add_product(x, y, true);
+        return *this;
+    }
+
+    inline Integer& Integer::mul_add(const Integer& y, const Integer& z) {
+        if (&z == this) {
+            auto z_copy = z;
+            return mul_add(y, z_copy);
+        }
+        *this *= y;
+        return *this += z;
+    }
+
+    inline Integer& Integer::mul_sub(const Integer& y, const Integer& z) {
+        if (&z == this) {
+            auto z_copy = z;
+            return mul_sub(y, z_copy);
+        }
+        *this *= y;
+        return *this -= z;
+    }
+
+    inline void Integer::add_product(const Integer& x, const Integer& y, bool negate) {
+
+        if (! x || ! y) {
+            return;
+        }
+
+        auto negative = (x.sign_ != y.sign_) != negate;
+
+        if (! mag_ || sign_ == negative) {
+            mag_.add_product(x.mag_, y.mag_);
+            sign_ = negative;
+        } else if (mag_.subtract_product(x.mag_, y.mag_)) {
+            sign_ = negative;
+        } else if (! mag_) {
+            sign_ = false;
+        }
+
+    }
+
+    inline void Integer::add_signed(const Natural& y, bool negative) {
+
+        if (! y) {
 
             // do nothing
 
         } else if (! mag_) {
 
-            mag_ = y.mag_;
-            sign_ = y.sign_;
+            mag_ = y;
+            sign_ = negative;
 
-        } else if (sign_ == y.sign_) {
+        } else if (sign_ == negative) {
 
-            mag_ += y.mag_;
+            mag_ += y;
 
         } else {
 
-            auto c = mag_ <=> y.mag_;
+            auto c = mag_ <=> y;
 
             if (c == std::strong_ordering::less) {
-                mag_ = y.mag_ - mag_;
+                mag_.subtract_from(y);
                 sign_ = ! sign_;
             } else if (c == std::strong_ordering::greater) {
-                mag_ -= y.mag_;
+                mag_ -= y;
             } else {
-                mag_ = {};
+                mag_.words_.clear();
                 sign_ = false;
             }
 
         }
 
-        return *this;
-
     }
 
     inline Integer operator*(const Integer& x, const Integer& y) {
@@ -905,18 +2072,21 @@ namespace RS {
     }
 
     template <std::signed_integral T>
-    Integer operator+(const Integer& x, T y) {
-        return x + Integer{y};
+    Integer operator+(Integer x, T y) {
+        x += y;
+        return x;
     }
 
     template <std::signed_integral T>
-    Integer operator-(const Integer& x, T y) {
-        return x - Integer{y};
+    Integer operator-(Integer x, T y) {
+        x -= y;
+        return x;
     }
 
     template <std::signed_integral T>
-    Integer operator*(const Integer& x, T y) {
-        return x * Integer{y};
+    Integer operator*(Integer x, T y) {
+        x *= y;
+        return x;
     }
 
     template <std::signed_integral T>
@@ -930,8 +2100,9 @@ namespace RS {
     }
 
     template <std::signed_integral T>
-    Integer operator+(T x, const Integer& y) {
-        return Integer{x} + y;
+    Integer operator+(T x, Integer y) {
+        y += x;
+        return y;
     }
 
     template <std::signed_integral T>
@@ -940,8 +2111,9 @@ namespace RS {
     }
 
     template <std::signed_integral T>
-    Integer operator*(T x, const Integer& y) {
-        return Integer{x} * y;
+    Integer operator*(T x, Integer y) {
+        y *= x;
+        return y;
     }
 
     template <std::signed_integral T>
@@ -983,6 +2155,18 @@ namespace RS {
         return x <=> Integer{y};
     }
 
+    inline Integer gcd(const Integer& x, const Integer& y) {
+        Integer z;
+        z.mag_ = gcd(x.mag_, y.mag_);
+        return z;
+    }
+
+    inline Integer lcm(const Integer& x, const Integer& y) {
+        Integer z;
+        z.mag_ = lcm(x.mag_, y.mag_);
+        return z;
+    }
+
     inline std::pair<Integer, Integer> Integer::divide(const Integer& y) const {
 
         std::pair<Integer, Integer> qr;
@@ -1094,6 +2278,60 @@ namespace RS {
 
     }
 
+    inline Natural Natural::multiply_toom3(const Natural& x, const Natural& y) {
+
+        // Toom-Cook 3-way multiplication, using Bodrato's evaluation points
+        // (0,1,-1,-2,inf) and interpolation sequence
+
+        auto k = (x.words_.size() + 2) / 3;
+        auto x0 = x.slice(0, k);
+        auto x1 = x.slice(k, k);
+        auto x2 = x.slice(2 * k, npos);
+        auto y0 = y.slice(0, k);
+        auto y1 = y.slice(k, k);
+        auto y2 = y.slice(2 * k, npos);
+
+        auto evaluate = [] (const Natural& a0, const Natural& a1, const Natural& a2) {
+            auto a02 = a0 + a2;
+            Integer p1 = a02 + a1;
+            auto pm1 = Integer(a02) - Integer(a1);
+            auto pm2 = (pm1 + Integer(a2)) * 2 - Integer(a0);
+            return std::tuple{p1, pm1, pm2};
+        };
+
+        auto [p1, pm1, pm2] = evaluate(x0, x1, x2);
+        auto [q1, qm1, qm2] = evaluate(y0, y1, y2);
+
+        Integer r0 = x0 * y0;
+        Integer r1 = p1 * q1;
+        auto rm1 = pm1 * qm1;
+        auto rm2 = pm2 * qm2;
+        Integer rinf = x2 * y2;
+
+        // All divisions here are exact
+
+        auto t3 = rm2 - r1;
+        t3.mag_.divide_word(3);
+        auto t1 = r1 - rm1;
+        t1.mag_ >>= 1;
+        auto t2 = rm1 - r0;
+        t3 = t2 - t3;
+        t3.mag_ >>= 1;
+        t3 += rinf * 2;
+        t2 += t1;
+        t2 -= rinf;
+        t1 -= t3;
+
+        auto z = std::move(r0.mag_);
+        z.add_shifted(t1.mag_, k);
+        z.add_shifted(t2.mag_, 2 * k);
+        z.add_shifted(t3.mag_, 3 * k);
+        z.add_shifted(rinf.mag_, 4 * k);
+
+        return z;
+
+    }
+
     // Concepts
 
     template <typename T>
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "rs-core/global.hpp"
+#include "rs-core/thread-pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace RS {
+
+    namespace Detail {
+
+        // Aim for several chunks per thread, so that stealing can even out
+        // irregular workloads
+
+        constexpr std::size_t parallel_chunks_per_thread = 8;
+        constexpr std::size_t parallel_sort_min_grain = 1024;
+
+        inline std::size_t parallel_grain(const ThreadPool& pool, std::size_t n, std::size_t grain,
+                std::size_t min_grain = 1) noexcept {
+            if (grain == 0) {
+                grain = std::max(n / (parallel_chunks_per_thread * pool.threads()), min_grain);
+            }
+            return std::max(grain, 1uz);
+        }
+
+        // The failure flag is set when a callback throws, so that pieces of
+        // work that have not started yet are abandoned; the task group
+        // rethrows the exception
+
+        template <typename F>
+        void parallel_guard(std::atomic<bool>& failed, F&& f) {
+            try {
+                f();
+            }
+            catch (...) {
+                failed.store(true, std::memory_order::relaxed);
+                throw;
+            }
+        }
+
+        // Split the range in half recursively, queueing the upper half and
+        // keeping the lower half, until it is no larger than the grain size.
+        // Jobs queued from a worker go on its own deque, so idle workers
+        // steal the largest remaining pieces first.
+
+        template <std::integral T, typename F>
+        void parallel_split(TaskGroup& group, std::atomic<bool>& failed, T begin, T end, std::size_t grain, const F& f) {
+
+            while (static_cast<std::size_t>(end - begin) > grain && ! failed.load(std::memory_order::relaxed)) {
+                auto mid = static_cast<T>(begin + (end - begin) / 2);
+                group.insert([&group, &failed, mid, end, grain, &f] { parallel_split(group, failed, mid, end, grain, f); });
+                end = mid;
+            }
+
+            if (! failed.load(std::memory_order::relaxed)) {
+                parallel_guard(failed, [begin, end, &f] { f(begin, end); });
+            }
+
+        }
+
+        template <std::integral T, typename F>
+        void parallel_blocks(ThreadPool& pool, T begin, T end, std::size_t grain, const F& f) {
+
+            if (end <= begin) {
+                return;
+            }
+
+            grain = parallel_grain(pool, static_cast<std::size_t>(end - begin), grain);
+            std::atomic<bool> failed {false};
+            TaskGroup group{pool};
+            group.insert([&group, &failed, begin, end, grain, &f] { parallel_split(group, failed, begin, end, grain, f); });
+            group.wait();
+
+        }
+
+        // Merge two sorted runs by splitting the larger one at its midpoint
+        // and the smaller one at the matching position, so that the two
+        // halves of the output can be merged independently. Elements are
+        // moved from the input runs.
+
+        template <typename I, typename O, typename C>
+        void parallel_merge(TaskGroup& group, std::atomic<bool>& failed, I a1, I a2, I b1, I b2, O out,
+                std::size_t grain, const C& compare) {
+
+            while (! failed.load(std::memory_order::relaxed)) {
+
+                auto na = static_cast<std::size_t>(a2 - a1);
+                auto nb = static_cast<std::size_t>(b2 - b1);
+
+                if (na + nb <= grain || na == 0 || nb == 0) {
+                    parallel_guard(failed, [=, &compare] {
+                        std::merge(std::make_move_iterator(a1), std::make_move_iterator(a2),
+                            std::make_move_iterator(b1), std::make_move_iterator(b2), out, compare);
+                    });
+                    return;
+                }
+
+                I am, bm;
+
+                parallel_guard(failed, [&] {
+                    if (na >= nb) {
+                        am = a1 + na / 2;
+                        bm = std::lower_bound(b1, b2, *am, compare);
+                    } else {
+                        bm = b1 + nb / 2;
+                        am = std::upper_bound(a1, a2, *bm, compare);
+                    }
+                });
+
+                auto out_mid = out + ((am - a1) + (bm - b1));
+                group.insert([&group, &failed, am, a2, bm, b2, out_mid, grain, &compare] {
+                    parallel_merge(group, failed, am, a2, bm, b2, out_mid, grain, compare);
+                });
+                a2 = am;
+                b2 = bm;
+
+            }
+
+        }
+
+    }
+
+    template <std::integral T, std::invocable<T> F>
+    void parallel_for(ThreadPool& pool, T begin, T end, F&& f, std::size_t grain = 0) {
+        auto block = [&f] (T i, T j) {
+            for (; i < j; ++i) {
+                std::invoke(f, i);
+            }
+        };
+        Detail::parallel_blocks(pool, begin, end, grain, block);
+    }
+
+    template <std::ranges::random_access_range Range, std::random_access_iterator Out, typename F>
+    requires std::ranges::sized_range<Range>
+        && std::invocable<F&, std::ranges::range_reference_t<const Range>>
+    Out parallel_transform(ThreadPool& pool, const Range& range, Out out, F&& f, std::size_t grain = 0) {
+        auto in = std::ranges::begin(range);
+        auto n = std::ranges::size(range);
+        auto block = [in, out, &f] (std::size_t i, std::size_t j) {
+            std::transform(in + i, in + j, out + i, std::ref(f));
+        };
+        Detail::parallel_blocks(pool, 0uz, n, grain, block);
+        return out + n;
+    }
+
+    template <std::ranges::random_access_range Range, typename T, typename BinaryOp>
+    requires std::ranges::sized_range<Range>
+        && std::constructible_from<T, std::ranges::range_reference_t<const Range>>
+        && std::invocable<BinaryOp&, T, std::ranges::range_reference_t<const Range>>
+        && std::invocable<BinaryOp&, T, T>
+    T parallel_reduce(ThreadPool& pool, const Range& range, T init, BinaryOp combine, std::size_t grain = 0) {
+
+        // Each chunk is reduced separately, and the partial results are
+        // combined in order, so the operation needs to be associative but
+        // not commutative
+
+        auto in = std::ranges::begin(range);
+        auto n = std::ranges::size(range);
+
+        if (n == 0) {
+            return init;
+        }
+
+        grain = Detail::parallel_grain(pool, n, grain);
+        auto chunks = (n + grain - 1) / grain;
+        std::vector<std::optional<T>> partial(chunks);
+
+        parallel_for(pool, 0uz, chunks, [in, n, grain, &combine, &partial] (std::size_t k) {
+            auto i = k * grain;
+            auto j = std::min(i + grain, n);
+            T sum(in[i]);
+            for (++i; i < j; ++i) {
+                sum = std::invoke(combine, std::move(sum), in[i]);
+            }
+            partial[k].emplace(std::move(sum));
+        }, 1);
+
+        for (auto& sum: partial) {
+            init = std::invoke(combine, std::move(init), std::move(*sum));
+        }
+
+        return init;
+
+    }
+
+    template <std::ranges::random_access_range Range, typename Compare = std::ranges::less>
+    requires std::ranges::sized_range<Range>
+        && std::sortable<std::ranges::iterator_t<Range>, Compare>
+    void parallel_sort(ThreadPool& pool, Range&& range, Compare compare = {}, std::size_t grain = 0) {
+
+        using value_type = std::ranges::range_value_t<Range>;
+
+        auto first = std::ranges::begin(range);
+        auto n = std::ranges::size(range);
+        grain = Detail::parallel_grain(pool, n, grain, Detail::parallel_sort_min_grain);
+
+        if (n <= grain) {
+            std::sort(first, first + n, compare);
+            return;
+        }
+
+        // Sort runs of the grain size, then merge pairs of runs back and
+        // forth between the range and a buffer
+
+        std::vector<value_type> buffer(std::make_move_iterator(first), std::make_move_iterator(first + n));
+
+        parallel_for(pool, 0uz, (n + grain - 1) / grain, [&buffer, n, grain, &compare] (std::size_t k) {
+            auto i = k * grain;
+            auto j = std::min(i + grain, n);
+            std::sort(buffer.begin() + i, buffer.begin() + j, compare);
+        }, 1);
+
+        auto in_buffer = true;
+
+        for (auto width = grain; width < n; width *= 2) {
+
+            std::atomic<bool> failed {false};
+            TaskGroup group{pool};
+
+            auto merge_pass = [&] (auto src, auto dst) {
+                for (auto i = 0uz; i < n; i += 2 * width) {
+                    auto mid = std::min(i + width, n);
+                    auto j = std::min(i + 2 * width, n);
+                    group.insert([&group, &failed, src, dst, i, mid, j, grain, &compare] {
+                        Detail::parallel_merge(group, failed, src + i, src + mid, src + mid, src + j, dst + i, grain, compare);
+                    });
+                }
+            };
+
+            if (in_buffer) {
+                merge_pass(buffer.begin(), first);
+            } else {
+                merge_pass(first, buffer.begin());
+            }
+
+            group.wait();
+            in_buffer = ! in_buffer;
+
+        }
+
+        if (in_buffer) {
+            parallel_for(pool, 0uz, n, [&buffer, first] (std::size_t i) {
+                first[i] = std::move(buffer[i]);
+            }, grain);
+        }
+
+    }
+
+}
@@ -491,8 +491,10 @@ namespace RS {
             den_ = - den_;
         }
         auto common = gcd(num_, den_);
-        num_ /= common;
-        den_ /= common;
+        if (common != T{1}) {
+            num_ /= common;
+            den_ /= common;
+        }
     }
 
     template <SignedIntegral T>
@@ -5,24 +5,161 @@
 #include <atomic>
 #include <chrono>
 #include <concepts>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <exception>
 #include <functional>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <random>
 #include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace RS {
 
+    namespace Detail {
+
+        // Chase-Lev work stealing deque (Le, Pop, Cohen & Nardelli 2013).
+        // Only the owning thread may call push() and pop(); any thread may
+        // call steal(). The deque does not own the objects it points to.
+
+        template <typename T>
+        class WorkStealingDeque {
+
+        public:
+
+            WorkStealingDeque() { rings_.push_back(std::make_unique<ring>(initial_capacity)); ring_ = rings_.back().get(); }
+
+            WorkStealingDeque(const WorkStealingDeque&) = delete;
+            WorkStealingDeque(WorkStealingDeque&&) = delete;
+            WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+            WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+            bool empty() const noexcept { return bottom_.load() <= top_.load(); }
+            std::size_t size() const noexcept;
+            void push(T* x);
+            T* pop() noexcept;
+            T* steal() noexcept;
+
+        private:
+
+            struct ring {
+                std::size_t mask;
+                std::unique_ptr<std::atomic<T*>[]> slots;
+                explicit ring(std::size_t capacity): mask(capacity - 1), slots(new std::atomic<T*>[capacity]) {}
+                T* get(std::int64_t i) const noexcept { return slots[static_cast<std::size_t>(i) & mask].load(std::memory_order::relaxed); }
+                void put(std::int64_t i, T* x) noexcept { slots[static_cast<std::size_t>(i) & mask].store(x, std::memory_order::relaxed); }
+            };
+
+            static constexpr std::size_t initial_capacity = 64;
+
+            // Replaced rings are kept until the deque is destroyed, because a
+            // thief may still be reading from one
+
+            alignas(64) std::atomic<std::int64_t> top_ {0};
+            alignas(64) std::atomic<std::int64_t> bottom_ {0};
+            std::atomic<ring*> ring_ {nullptr};
+            std::vector<std::unique_ptr<ring>> rings_;
+
+        };
+
+            template <typename T>
+            void WorkStealingDeque<T>::push(T* x) {
+
+                auto b = bottom_.load(std::memory_order::relaxed);
+                auto t = top_.load(std::memory_order::acquire);
+                auto r = ring_.load(std::memory_order::relaxed);
+
+                if (static_cast<std::size_t>(b - t) > r->mask) {
+                    auto bigger = std::make_unique<ring>(2 * (r->mask + 1));
+                    for (auto i = t; i < b; ++i) {
+                        bigger->put(i, r->get(i));
+                    }
+                    r = bigger.get();
+                    rings_.push_back(std::move(bigger));
+                    ring_.store(r, std::memory_order::release);
+                }
+
+                r->put(b, x);
+                bottom_.store(b + 1, std::memory_order::release);
+
+            }
+
+            template <typename T>
+            std::size_t WorkStealingDeque<T>::size() const noexcept {
+                auto b = bottom_.load(std::memory_order::relaxed);
+                auto t = top_.load(std::memory_order::relaxed);
+                return b > t ? static_cast<std::size_t>(b - t) : 0;
+            }
+
+            template <typename T>
+            T* WorkStealingDeque<T>::pop() noexcept {
+
+                auto b = bottom_.load(std::memory_order::relaxed) - 1;
+                auto r = ring_.load(std::memory_order::relaxed);
+                bottom_.store(b, std::memory_order::seq_cst);
+                auto t = top_.load(std::memory_order::seq_cst);
+
+                if (t > b) {
+                    bottom_.store(b + 1, std::memory_order::release);
+                    return nullptr;
+                }
+
+                auto x = r->get(b);
+
+                if (t == b) {
+                    // Last item: race any thieves for it
+                    if (! top_.compare_exchange_strong(t, t + 1, std::memory_order::seq_cst, std::memory_order::relaxed)) {
+                        x = nullptr;
+                    }
+                    bottom_.store(b + 1, std::memory_order::release);
+                }
+
+                return x;
+
+            }
+
+            template <typename T>
+            T* WorkStealingDeque<T>::steal() noexcept {
+
+                auto t = top_.load(std::memory_order::seq_cst);
+                auto b = bottom_.load(std::memory_order::seq_cst);
+
+                if (t >= b) {
+                    return nullptr;
+                }
+
+                auto x = ring_.load(std::memory_order::acquire)->get(t);
+
+                if (! top_.compare_exchange_strong(t, t + 1, std::memory_order::seq_cst, std::memory_order::relaxed)) {
+                    return nullptr;
+                }
+
+                return x;
+
+            }
+
+    }
+
     class ThreadPool {
 
     public:
 
         using clock = std::chrono::steady_clock;
 
+        struct worker_stats {
+            std::size_t jobs_executed = 0;
+            std::size_t jobs_stolen = 0;
+            clock::duration idle_time {};
+            std::size_t deque_high_water = 0;
+            std::size_t inject_high_water = 0;
+        };
+
         ThreadPool(): ThreadPool{0} {}
         explicit ThreadPool(std::size_t threads);
         ~ThreadPool() noexcept;
@@ -35,7 +172,9 @@ namespace RS {
         void clear() noexcept;
         template <std::invocable<> F> void insert(F&& f);
         template <std::invocable<> F> void operator()(F&& f) { insert(std::forward<F>(f)); }
+        template <std::invocable<> F> std::future<std::invoke_result_t<std::decay_t<F>&>> submit(F&& f);
         bool poll() { return ! unfinished_jobs_; }
+        std::vector<worker_stats> stats() const;
         std::size_t threads() const noexcept { return workers_.size(); }
         void wait();
         template <typename R, typename P> bool wait_for(std::chrono::duration<R, P> dt);
@@ -43,26 +182,121 @@ namespace RS {
 
     private:
 
-        static constexpr std::chrono::microseconds poll_interval {100};
+        friend class TaskGroup;
+
+        // Number of failed attempts to find work an idle worker makes before
+        // it parks
+
+        static constexpr int spin_count = 64;
+
+        struct job {
+            virtual ~job() = default;
+            virtual void run() = 0;
+        };
+
+        template <typename F>
+        struct job_impl: job {
+            F call;
+            template <typename G> explicit job_impl(G&& g): call(std::forward<G>(g)) {}
+            void run() override { call(); }
+        };
+
+        using job_ptr = std::unique_ptr<job>;
+
+        // Jobs queued from outside the pool go on a worker's injection
+        // queue, which has its own lock, so external threads only contend
+        // with each other and with the workers when they pick the same
+        // worker. The statistics are only written by the worker's own
+        // thread, apart from the injection high water mark, which is written
+        // under the injection lock, but can be read from any thread. The
+        // idle start time is zero while the worker is busy.
 
         struct worker {
-            std::mutex mutex;
-            std::deque<std::function<void()>> queue;
+            Detail::WorkStealingDeque<job> deque;
+            std::mutex inject_mutex;
+            std::deque<job_ptr> inject_queue;
+            std::atomic<std::size_t> inject_size {0};
+            std::minstd_rand rng;
             std::thread thread;
+            std::atomic<std::size_t> jobs_executed {0};
+            std::atomic<std::size_t> jobs_stolen {0};
+            std::atomic<std::size_t> deque_high_water {0};
+            std::atomic<std::size_t> inject_high_water {0};
+            std::atomic<clock::rep> idle_ticks {0};
+            std::atomic<clock::rep> idle_since {0};
         };
 
+        static inline thread_local ThreadPool* current_pool_ = nullptr;
+        static inline thread_local worker* current_worker_ = nullptr;
+
         std::atomic<std::size_t> clear_count_ {0};
         std::atomic<std::size_t> next_worker_ {0};
         std::atomic<std::size_t> unfinished_jobs_ {0};
+        std::atomic<std::size_t> queued_jobs_ {0};
+        std::atomic<std::size_t> sleeping_workers_ {0};
         std::atomic<bool> shutting_down_ {false};
+        std::mutex sleep_mutex_;
+        std::condition_variable sleep_cv_;
+        std::mutex done_mutex_;
+        std::condition_variable done_cv_;
         std::vector<worker> workers_;
 
+        void enqueue(job_ptr j);
+        void job_done(std::size_t n) noexcept;
+        void run_job(worker& w, job_ptr j) noexcept;
+        bool try_run_job(worker& w) noexcept;
+        job_ptr take_injected(worker& w) noexcept;
+        job_ptr take_job(worker& w) noexcept;
         void thread_payload(worker* wptr) noexcept;
 
         static std::size_t actual_threads(std::size_t threads) noexcept;
         template <std::invocable<> F> static bool callback_is_null(F&&) { return false; }
         static bool callback_is_null(void (*f)()) { return f == nullptr; }
-        static bool callback_is_null(std::function<void()> f) { return ! f; }
+        static bool callback_is_null(const std::function<void()>& f) { return ! f; }
+
+    };
+
+    class TaskGroup {
+
+    public:
+
+        using clock = ThreadPool::clock;
+
+        explicit TaskGroup(ThreadPool& pool): pool_(&pool), state_(std::make_shared<state_type>()) {}
+        ~TaskGroup() noexcept;
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup(TaskGroup&&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+        TaskGroup& operator=(TaskGroup&&) = delete;
+
+        template <std::invocable<> F> void insert(F&& f);
+        template <std::invocable<> F> void operator()(F&& f) { insert(std::forward<F>(f)); }
+        template <std::invocable<> F> std::future<std::invoke_result_t<std::decay_t<F>&>> submit(F&& f);
+        bool poll() const noexcept { return ! state_->unfinished_jobs; }
+        ThreadPool& pool() const noexcept { return *pool_; }
+        void wait();
+        template <typename R, typename P> bool wait_for(std::chrono::duration<R, P> dt);
+        bool wait_until(clock::time_point tp);
+
+    private:
+
+        // Jobs hold a reference to the shared state, so a job that is still
+        // releasing its token never touches a destroyed group
+
+        struct state_type {
+            std::atomic<std::size_t> unfinished_jobs {0};
+            std::mutex mutex;
+            std::condition_variable done;
+            std::exception_ptr error;
+            void job_done() noexcept;
+        };
+
+        ThreadPool* pool_;
+        std::shared_ptr<state_type> state_;
+
+        void check_error();
+        void wait_for_jobs() noexcept;
 
     };
 
@@ -78,6 +312,12 @@ namespace RS {
         clear();
         shutting_down_ = true;
 
+        {
+            std::unique_lock lock{sleep_mutex_};
+        }
+
+        sleep_cv_.notify_all();
+
         for (auto& w: workers_) {
             w.thread.join();
         }
@@ -87,13 +327,28 @@ namespace RS {
     inline void ThreadPool::clear() noexcept {
 
         ++clear_count_;
+        auto discarded = 0uz;
 
         for (auto& w: workers_) {
-            std::unique_lock lock{w.mutex};
-            w.queue.clear();
+            while (! w.deque.empty()) {
+                if (job_ptr j{w.deque.steal()}) {
+                    ++discarded;
+                }
+            }
+            std::deque<job_ptr> discard;
+            {
+                std::unique_lock lock{w.inject_mutex};
+                discard.swap(w.inject_queue);
+                w.inject_size = 0;
+            }
+            discarded += discard.size();
+        }
+
+        if (discarded != 0) {
+            queued_jobs_ -= discarded;
+            job_done(discarded);
         }
 
-        unfinished_jobs_ = 0;
         wait();
         --clear_count_;
 
@@ -101,23 +356,23 @@ namespace RS {
 
     template <std::invocable<> F>
     void ThreadPool::insert(F&& f) {
-
-        if (clear_count_ || callback_is_null(std::forward<F>(f))) {
-            return;
+        if (! clear_count_ && ! callback_is_null(f)) {
+            enqueue(std::make_unique<job_impl<std::decay_t<F>>>(std::forward<F>(f)));
         }
+    }
 
-        auto index = next_worker_++ % threads();
-        auto& w = workers_[index];
-        ++unfinished_jobs_;
-        std::unique_lock lock{w.mutex};
-        w.queue.emplace_back(std::forward<F>(f));
-
+    template <std::invocable<> F>
+    std::future<std::invoke_result_t<std::decay_t<F>&>> ThreadPool::submit(F&& f) {
+        using result_type = std::invoke_result_t<std::decay_t<F>&>;
+        auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(f));
+        auto future = task->get_future();
+        insert([task] { (*task)(); });
+        return future;
     }
 
     inline void ThreadPool::wait() {
-        while (unfinished_jobs_) {
-            std::this_thread::sleep_for(poll_interval);
-        }
+        std::unique_lock lock{done_mutex_};
+        done_cv_.wait(lock, [this] { return ! unfinished_jobs_; });
     }
 
     template <typename R, typename P>
@@ -126,57 +381,205 @@ namespace RS {
     }
 
     inline bool ThreadPool::wait_until(clock::time_point tp) {
+        std::unique_lock lock{done_mutex_};
+        return done_cv_.wait_until(lock, tp, [this] { return ! unfinished_jobs_; });
+    }
 
-        for (;;) {
+    inline void ThreadPool::enqueue(job_ptr j) {
 
-            if (! unfinished_jobs_) {
-                return true;
-            } else if (clock::now() >= tp) {
-                return false;
+        // A job queued from one of this pool's own workers goes on that
+        // worker's deque, where it can be taken without locking; anything
+        // else goes on the workers' injection queues in rotation
+
+        ++unfinished_jobs_;
+
+        if (current_pool_ == this) {
+            auto& w = *current_worker_;
+            w.deque.push(j.get());
+            j.release();
+            auto size = w.deque.size();
+            if (size > w.deque_high_water.load(std::memory_order::relaxed)) {
+                w.deque_high_water.store(size, std::memory_order::relaxed);
+            }
+        } else {
+            auto& w = workers_[next_worker_++ % threads()];
+            std::unique_lock lock{w.inject_mutex};
+            w.inject_queue.push_back(std::move(j));
+            ++w.inject_size;
+            if (w.inject_queue.size() > w.inject_high_water.load(std::memory_order::relaxed)) {
+                w.inject_high_water.store(w.inject_queue.size(), std::memory_order::relaxed);
+            }
+        }
+
+        // The queued count is incremented before the sleeper count is read,
+        // and a parking worker does the reverse, so at least one of them
+        // will see the other
+
+        ++queued_jobs_;
+
+        if (sleeping_workers_ != 0) {
+            {
+                std::unique_lock lock{sleep_mutex_};
+            }
+            sleep_cv_.notify_one();
+        }
+
+    }
+
+    inline void ThreadPool::job_done(std::size_t n) noexcept {
+
+        // Taking the lock before notifying ensures that a waiter cannot miss
+        // the wakeup between checking the count and blocking
+
+        if (unfinished_jobs_ -= n) {
+            return;
+        }
+
+        {
+            std::unique_lock lock{done_mutex_};
+        }
+
+        done_cv_.notify_all();
+
+    }
+
+    inline std::vector<ThreadPool::worker_stats> ThreadPool::stats() const {
+
+        std::vector<worker_stats> result;
+        result.reserve(workers_.size());
+        auto now = clock::now().time_since_epoch().count();
+
+        for (auto& w: workers_) {
+            auto& s = result.emplace_back();
+            s.jobs_executed = w.jobs_executed.load(std::memory_order::relaxed);
+            s.jobs_stolen = w.jobs_stolen.load(std::memory_order::relaxed);
+            s.deque_high_water = w.deque_high_water.load(std::memory_order::relaxed);
+            s.inject_high_water = w.inject_high_water.load(std::memory_order::relaxed);
+            auto ticks = w.idle_ticks.load(std::memory_order::relaxed);
+            auto since = w.idle_since.load(std::memory_order::relaxed);
+            if (since != 0 && now > since) {
+                ticks += now - since;
             }
+            s.idle_time = clock::duration{ticks};
+        }
 
-            std::this_thread::sleep_for(poll_interval);
+        return result;
 
+    }
+
+    inline void ThreadPool::run_job(worker& w, job_ptr j) noexcept {
+        j->run();
+        j.reset();
+        w.jobs_executed.fetch_add(1, std::memory_order::relaxed);
+        job_done(1);
+    }
+
+    inline bool ThreadPool::try_run_job(worker& w) noexcept {
+        auto j = take_job(w);
+        if (! j) {
+            return false;
         }
+        run_job(w, std::move(j));
+        return true;
+    }
+
+    inline ThreadPool::job_ptr ThreadPool::take_injected(worker& w) noexcept {
+
+        // The size is checked first so that idle workers scanning for work
+        // do not take the lock on empty queues
+
+        job_ptr j;
+
+        if (w.inject_size != 0) {
+            std::unique_lock lock{w.inject_mutex};
+            if (! w.inject_queue.empty()) {
+                j = std::move(w.inject_queue.front());
+                w.inject_queue.pop_front();
+                --w.inject_size;
+            }
+        }
+
+        return j;
+
+    }
+
+    inline ThreadPool::job_ptr ThreadPool::take_job(worker& w) noexcept {
+
+        // Look for work in the worker's own deque, then its own injection
+        // queue, then other workers' deques and injection queues
+
+        job_ptr j{w.deque.pop()};
+
+        if (! j) {
+            j = take_injected(w);
+        }
+
+        if (! j) {
+            auto n = threads();
+            auto start = w.rng() % n;
+            for (auto i = 0uz; i < n && ! j; ++i) {
+                auto& victim = workers_[(start + i) % n];
+                if (&victim != &w) {
+                    j.reset(victim.deque.steal());
+                    if (j) {
+                        w.jobs_stolen.fetch_add(1, std::memory_order::relaxed);
+                    } else {
+                        j = take_injected(victim);
+                    }
+                }
+            }
+        }
+
+        if (j) {
+            --queued_jobs_;
+        }
+
+        return j;
 
     }
 
     inline void ThreadPool::thread_payload(worker* wptr) noexcept {
 
-        auto seed = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(wptr));
-        std::minstd_rand rng{seed};
-        std::function<void()> call;
-        worker* alt_worker;
+        current_pool_ = this;
+        current_worker_ = wptr;
+        wptr->rng.seed(static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(wptr)));
+        auto idle = 0;
+        clock::time_point idle_start;
 
         while (! shutting_down_) {
 
-            call = {};
+            auto j = take_job(*wptr);
 
-            {
-                std::unique_lock lock{wptr->mutex};
-                if (! wptr->queue.empty()) {
-                    call = std::move(wptr->queue.back());
-                    wptr->queue.pop_back();
+            if (j) {
+
+                if (idle != 0) {
+                    wptr->idle_since.store(0, std::memory_order::relaxed);
+                    wptr->idle_ticks.fetch_add((clock::now() - idle_start).count(), std::memory_order::relaxed);
+                    idle = 0;
                 }
+
+                run_job(*wptr, std::move(j));
+                continue;
+
             }
 
-            if (! call && workers_.size() >= 2) {
-                do {
-                    auto index = rng() % threads();
-                    alt_worker = &workers_[index];
-                } while (alt_worker != wptr);
-                std::unique_lock lock{alt_worker->mutex};
-                if (! alt_worker->queue.empty()) {
-                    call = std::move(alt_worker->queue.front());
-                    alt_worker->queue.pop_front();
-                }
+            if (idle == 0) {
+                idle_start = clock::now();
+                wptr->idle_since.store(idle_start.time_since_epoch().count(), std::memory_order::relaxed);
             }
 
-            if (call) {
-                call();
-                --unfinished_jobs_;
+            if (++idle < spin_count) {
+
+                std::this_thread::yield();
+
             } else {
-                std::this_thread::sleep_for(poll_interval);
+
+                std::unique_lock lock{sleep_mutex_};
+                ++sleeping_workers_;
+                sleep_cv_.wait(lock, [this] { return queued_jobs_ != 0 || shutting_down_; });
+                --sleeping_workers_;
+                idle = 1; // Still idle, but spin again before parking
+
             }
 
         }
@@ -190,4 +593,118 @@ namespace RS {
         return std::max(threads, 2uz);
     }
 
+    inline TaskGroup::~TaskGroup() noexcept {
+        wait_for_jobs();
+    }
+
+    template <std::invocable<> F>
+    void TaskGroup::insert(F&& f) {
+
+        if (ThreadPool::callback_is_null(f)) {
+            return;
+        }
+
+        // The completion token is released when the last copy of the job is
+        // destroyed, whether it was executed or discarded by clear()
+
+        ++state_->unfinished_jobs;
+        std::shared_ptr<state_type> token{state_.get(), [state = state_] (state_type*) { state->job_done(); }};
+
+        pool_->insert([token, f = std::forward<F>(f)] () mutable {
+            try {
+                f();
+            }
+            catch (...) {
+                std::unique_lock lock{token->mutex};
+                if (! token->error) {
+                    token->error = std::current_exception();
+                }
+            }
+        });
+
+    }
+
+    template <std::invocable<> F>
+    std::future<std::invoke_result_t<std::decay_t<F>&>> TaskGroup::submit(F&& f) {
+        using result_type = std::invoke_result_t<std::decay_t<F>&>;
+        auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(f));
+        auto future = task->get_future();
+        insert([task] { (*task)(); });
+        return future;
+    }
+
+    inline void TaskGroup::wait() {
+        wait_for_jobs();
+        check_error();
+    }
+
+    template <typename R, typename P>
+    bool TaskGroup::wait_for(std::chrono::duration<R, P> dt) {
+        return wait_until(clock::now() + dt);
+    }
+
+    inline bool TaskGroup::wait_until(clock::time_point tp) {
+
+        // On a worker thread, run other queued jobs as wait_for_jobs() does,
+        // checking the deadline between jobs
+
+        if (ThreadPool::current_pool_ == pool_) {
+            while (state_->unfinished_jobs != 0) {
+                if (clock::now() >= tp) {
+                    return false;
+                }
+                if (! pool_->try_run_job(*ThreadPool::current_worker_)) {
+                    std::this_thread::yield();
+                }
+            }
+        } else {
+            std::unique_lock lock{state_->mutex};
+            if (! state_->done.wait_until(lock, tp, [this] { return ! state_->unfinished_jobs; })) {
+                return false;
+            }
+        }
+
+        check_error();
+        return true;
+
+    }
+
+    inline void TaskGroup::state_type::job_done() noexcept {
+        if (--unfinished_jobs == 0) {
+            {
+                std::unique_lock lock{mutex};
+            }
+            done.notify_all();
+        }
+    }
+
+    inline void TaskGroup::wait_for_jobs() noexcept {
+
+        // A worker thread that blocked here could starve the jobs it is
+        // waiting for, so it runs other queued jobs instead
+
+        if (ThreadPool::current_pool_ == pool_) {
+            while (state_->unfinished_jobs != 0) {
+                if (! pool_->try_run_job(*ThreadPool::current_worker_)) {
+                    std::this_thread::yield();
+                }
+            }
+        } else {
+            std::unique_lock lock{state_->mutex};
+            state_->done.wait(lock, [this] { return ! state_->unfinished_jobs; });
+        }
+
+    }
+
+    inline void TaskGroup::check_error() {
+        std::exception_ptr error;
+        {
+            std::unique_lock lock{state_->mutex};
+            error = std::exchange(state_->error, nullptr);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
 }
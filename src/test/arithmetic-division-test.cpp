@@ -3,6 +3,8 @@
 #include "rs-core/unit-test.hpp"
 #include <numeric>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 using namespace RS;
 using namespace RS::Literals;
@@ -299,4 +301,49 @@ void test_rs_core_arithmetic_gcd_lcm() {
 
     }
 
+    {
+
+        std::vector<Natural> fib {0_N, 1_N};
+        Natural x, y, z;
+        Integer a, b, c;
+
+        for (auto i = 2; i <= 1000; ++i) {
+            TRY(fib.push_back(fib[i - 1] + fib[i - 2]));
+        }
+
+        TRY(z = gcd(fib[1000], fib[999]));  TEST_EQUAL(z, 1_N);
+        TRY(z = gcd(fib[999], fib[1000]));  TEST_EQUAL(z, 1_N);
+        TRY(z = gcd(fib[900], fib[600]));   TEST_EQUAL(z, fib[300]);
+        TRY(z = gcd(fib[700], fib[560]));   TEST_EQUAL(z, fib[140]);
+        TRY(z = gcd(fib[997], fib[991]));   TEST_EQUAL(z, 1_N);
+        TRY(z = lcm(fib[900], fib[600]));   TEST_EQUAL(z, fib[900] * fib[600] / fib[300]);
+
+        for (auto [m,n]: {std::pair{1000, 750}, {3001, 2000}, {4096, 64}, {997, 991}}) {
+            TRY(x = (Natural{1u} << m) - 1u);
+            TRY(y = (Natural{1u} << n) - 1u);
+            TRY(z = gcd(x, y));
+            TEST_EQUAL(z, (Natural{1u} << std::gcd(m, n)) - 1u);
+            TEST_EQUAL(z, gcd<Natural>(x, y));
+        }
+
+        TRY(x = fib[800] << 100);
+        TRY(y = fib[500] << 37);
+        TRY(z = gcd(x, y));         TEST_EQUAL(z, fib[100] << 37);
+        TRY(z = gcd(x, y << 500));  TEST_EQUAL(z, fib[100] << 100);
+        TRY(z = gcd(x, fib[500]));  TEST_EQUAL(z, fib[100]);
+        TRY(z = gcd(x, x));         TEST_EQUAL(z, x);
+        TRY(z = gcd(x, 0_N));       TEST_EQUAL(z, x);
+        TRY(z = gcd(x, 6_N));       TEST_EQUAL(z, gcd<Natural>(x, 6_N));
+        TRY(z = gcd(x, y * 77_N));  TEST_EQUAL(z, gcd<Natural>(x, y * 77_N));
+
+        TRY(a = - Integer{fib[900]});
+        TRY(b = Integer{fib[600]});
+        TRY(c = gcd(a, b));   TEST_EQUAL(c, Integer{fib[300]});
+        TRY(c = gcd(b, a));   TEST_EQUAL(c, Integer{fib[300]});
+        TRY(c = gcd(a, a));   TEST_EQUAL(c, - a);
+        TRY(c = lcm(a, b));   TEST_EQUAL(c, Integer{fib[900] * fib[600] / fib[300]});
+        TRY(c = lcm(a, 0));   TEST_EQUAL(c, 0);
+
+    }
+
 }
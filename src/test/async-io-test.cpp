@@ -0,0 +1,305 @@
+#include "rs-core/async-io.hpp"
+#include "rs-core/io.hpp"
+#include "rs-core/thread-pool.hpp"
+#include "rs-core/unit-test.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <mutex>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace RS;
+using namespace std::chrono;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    const inline fs::path test_file{"__async_io_test__"};
+
+    std::vector<AsyncIO::backend> available_backends() {
+        std::vector<AsyncIO::backend> backends {AsyncIO::backend::thread_pool};
+        AsyncIO io;
+        if (io.active_backend() == AsyncIO::backend::io_uring) {
+            backends.push_back(AsyncIO::backend::io_uring);
+        }
+        return backends;
+    }
+
+}
+
+void test_rs_core_async_io_read_write() {
+
+    static constexpr auto block_size = 1000uz;
+    static constexpr auto blocks = 100uz;
+
+    for (auto mode: available_backends()) {
+
+        std::vector<std::string> out(blocks), in(blocks);
+        std::vector<AsyncIO::result> results(blocks);
+        auto calls = 0uz;
+
+        for (auto i = 0uz; i < blocks; ++i) {
+            out[i] = std::string(block_size, static_cast<char>('A' + i % 26));
+            in[i] = std::string(block_size, '\0');
+        }
+
+        {
+            Fdio file(test_file, IO::write_only);
+            AsyncIO aio(16, mode);
+            TEST(aio.active_backend() == mode);
+            TEST_EQUAL(aio.capacity(), 16u);
+            TEST_EQUAL(aio.pending(), 0u);
+            for (auto i = 0uz; i < blocks; ++i) {
+                auto offset = static_cast<std::ptrdiff_t>(i * block_size);
+                TRY(aio.write(file, out[i].data(), block_size, offset, [&results, &calls, i] (const AsyncIO::result& r) {
+                    results[i] = r;
+                    ++calls;
+                }));
+                TEST(aio.pending() <= 16u);
+            }
+            TRY(aio.wait_all());
+            TEST_EQUAL(aio.pending(), 0u);
+            TEST_EQUAL(calls, blocks);
+            for (auto& r: results) {
+                TEST_EQUAL(r.bytes, block_size);
+                TEST(! r.error);
+            }
+        }
+
+        TEST_EQUAL(fs::file_size(test_file), block_size * blocks);
+        calls = 0;
+
+        {
+            Fdio file(test_file);
+            AsyncIO aio(32, mode);
+            for (auto i = 0uz; i < blocks; ++i) {
+                auto offset = static_cast<std::ptrdiff_t>((blocks - 1 - i) * block_size);
+                TRY(aio.read(file, in[blocks - 1 - i].data(), block_size, offset, [&calls] (const AsyncIO::result& r) {
+                    if (r.bytes == block_size) {
+                        ++calls;
+                    }
+                }));
+            }
+            auto reaped = 0uz;
+            TRY(reaped = aio.wait(blocks));
+            TEST(reaped > 0u);
+            while (aio.pending() > 0) {
+                TRY(aio.wait());
+            }
+            TEST_EQUAL(calls, blocks);
+            for (auto i = 0uz; i < blocks; ++i) {
+                TEST_EQUAL(in[i], out[i]);
+            }
+        }
+
+        {
+            Fdio file(test_file);
+            AsyncIO aio(4, mode);
+            std::string buf(10, '\0');
+            AsyncIO::result res;
+            auto offset = static_cast<std::ptrdiff_t>(block_size * blocks - 3);
+            TRY(aio.read(file, buf.data(), buf.size(), offset, [&res] (const AsyncIO::result& r) { res = r; }));
+            TEST_EQUAL(aio.pending(), 1u);
+            TEST_EQUAL(aio.submit(), 1u);
+            TRY(aio.wait());
+            TEST_EQUAL(res.bytes, 3u);
+            TEST(! res.error);
+            TEST_EQUAL(aio.poll(), 0u);
+        }
+
+        TRY(fs::remove(test_file));
+
+    }
+
+    TEST(! fs::exists(test_file));
+
+}
+
+void test_rs_core_async_io_errors() {
+
+    for (auto mode: available_backends()) {
+
+        {
+            Fdio file(test_file, IO::write_only);
+            AsyncIO aio(4, mode);
+            std::string buf(10, '\0');
+            AsyncIO::result res;
+            TRY(aio.read(file, buf.data(), buf.size(), 0, [&res] (const AsyncIO::result& r) { res = r; }));
+            TRY(aio.wait_all());
+            TEST_EQUAL(res.bytes, 0u);
+            TEST(res.error == std::errc::bad_file_descriptor);
+        }
+
+        {
+            Fdio file(test_file);
+            AsyncIO aio(4, mode);
+            std::string buf(10, '\0');
+            TRY(aio.read(file, buf.data(), buf.size(), 0, [] (const AsyncIO::result&) { throw std::runtime_error("oops"); }));
+            TEST_THROW(aio.wait_all(), std::runtime_error, "oops");
+            TEST_EQUAL(aio.pending(), 0u);
+        }
+
+        {
+
+            // Every callback runs even if an earlier one throws, and the
+            // destructor waits for everything that was submitted
+
+            Fdio file(test_file);
+            std::vector<std::string> bufs(8, std::string(10, '\0'));
+            auto calls = 0;
+
+            {
+                AsyncIO aio(8, mode);
+                for (auto& buf: bufs) {
+                    TRY(aio.read(file, buf.data(), buf.size(), 0, [&calls] (const AsyncIO::result&) {
+                        ++calls;
+                        throw std::runtime_error("oops");
+                    }));
+                }
+                TRY(aio.submit());
+            }
+
+            TEST_EQUAL(calls, 8);
+            calls = 0;
+
+            {
+                AsyncIO aio(8, mode);
+                for (auto& buf: bufs) {
+                    TRY(aio.read(file, buf.data(), buf.size(), 0, [&calls] (const AsyncIO::result&) {
+                        if (++calls % 2 == 0) {
+                            throw std::runtime_error("oops");
+                        }
+                    }));
+                }
+                while (aio.pending() > 0) {
+                    try {
+                        aio.wait(8);
+                    }
+                    catch (const std::runtime_error&) {}
+                }
+                TEST_EQUAL(calls, 8);
+            }
+
+        }
+
+        TRY(fs::remove(test_file));
+
+    }
+
+    TEST(! fs::exists(test_file));
+
+}
+
+void test_rs_core_async_io_thread_pool() {
+
+    static constexpr auto block_size = 512uz;
+    static constexpr auto blocks = 200uz;
+
+    std::string data;
+
+    for (auto i = 0uz; i < blocks; ++i) {
+        data += std::string(block_size, static_cast<char>('a' + i % 26));
+    }
+
+    {
+        Fdio file(test_file, IO::write_only);
+        TRY(file.write_str(data));
+    }
+
+    for (auto mode: available_backends()) {
+
+        ThreadPool pool{4};
+        std::vector<std::string> in(blocks, std::string(block_size, '\0'));
+        std::atomic<std::size_t> good {0};
+        std::mutex mutex;
+        std::vector<std::thread::id> callers;
+
+        {
+            Fdio file(test_file);
+            AsyncIO aio(pool, 64, mode);
+            TEST(aio.active_backend() == mode);
+            for (auto i = 0uz; i < blocks; ++i) {
+                auto offset = static_cast<std::ptrdiff_t>(i * block_size);
+                TRY(aio.read(file, in[i].data(), block_size, offset, [&, i] (const AsyncIO::result& r) {
+                    if (r.bytes == block_size && in[i] == std::string(block_size, static_cast<char>('a' + i % 26))) {
+                        ++good;
+                    }
+                    std::unique_lock lock{mutex};
+                    callers.push_back(std::this_thread::get_id());
+                }));
+            }
+            TRY(aio.wait_all());
+        }
+
+        TEST_EQUAL(good.load(), blocks);
+        TEST_EQUAL(callers.size(), blocks);
+        TEST(std::ranges::none_of(callers, [] (auto id) { return id == std::this_thread::get_id(); }));
+
+    }
+
+    TRY(fs::remove(test_file));
+    TEST(! fs::exists(test_file));
+
+}
+
+void test_rs_core_async_io_benchmark() {
+
+    static constexpr auto file_count = 1000uz;
+    static constexpr auto file_size = 4096uz;
+
+    fs::path dir {"__async_io_bench__"};
+    std::vector<fs::path> paths;
+    std::string data(file_size, 'x');
+
+    TRY(fs::create_directory(dir));
+
+    for (auto i = 0uz; i < file_count; ++i) {
+        paths.push_back(dir / std::format("file-{}", i));
+        Fdio file(paths.back(), IO::write_only);
+        file.write_str(data);
+    }
+
+    auto report = [] (const char* name, auto start, auto stop) {
+        auto total = duration_cast<duration<double>>(stop - start).count();
+        auto rate = static_cast<std::uint64_t>(static_cast<double>(file_count) / total);
+        std::println("... Files read per second ({}) = {}", name, rate);
+    };
+
+    std::vector<std::string> buffers(file_count, std::string(file_size, '\0'));
+
+    {
+        auto start = system_clock::now();
+        for (auto i = 0uz; i < file_count; ++i) {
+            Fdio file(paths[i]);
+            file.pread(buffers[i].data(), file_size, 0);
+        }
+        auto stop = system_clock::now();
+        report("synchronous", start, stop);
+    }
+
+    for (auto mode: available_backends()) {
+        std::vector<Fdio> files;
+        files.reserve(file_count);
+        AsyncIO aio(256, mode);
+        auto start = system_clock::now();
+        for (auto i = 0uz; i < file_count; ++i) {
+            files.emplace_back(paths[i]);
+            aio.read(files.back(), buffers[i].data(), file_size, 0);
+        }
+        aio.wait_all();
+        auto stop = system_clock::now();
+        report(mode == AsyncIO::backend::io_uring ? "io_uring" : "thread pool", start, stop);
+    }
+
+    TRY(fs::remove_all(dir));
+
+}
@@ -1,12 +1,20 @@
 #include "rs-core/compress.hpp"
+#include "rs-core/io.hpp"
 #include "rs-core/random.hpp"
+#include "rs-core/thread-pool.hpp"
 #include "rs-core/unit-test.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
+#include <print>
+#include <ranges>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 using namespace RS;
+using namespace std::chrono;
 
 namespace {
 
@@ -19,6 +27,44 @@ namespace {
         return str;
     }
 
+    template <Codec C>
+    void run_codec_benchmark(std::string_view codec_name, C& codec,
+            const std::vector<std::pair<std::string_view, std::string>>& corpus) {
+
+        static constexpr int iterations = 5;
+
+        auto mb_per_second = [] (std::size_t bytes, system_clock::duration time) {
+            return static_cast<double>(bytes) / 1e6 / duration_cast<duration<double>>(time).count();
+        };
+
+        for (auto& [name, original]: corpus) {
+
+            std::string compressed, decompressed;
+            system_clock::duration encode_time {}, decode_time {};
+
+            for (int i = 0; i < iterations; ++i) {
+                compressed.clear();
+                decompressed.clear();
+                auto start = system_clock::now();
+                TRY(codec.encode(original, compressed));
+                auto mid = system_clock::now();
+                TRY(codec.decode(compressed, decompressed));
+                auto stop = system_clock::now();
+                encode_time += mid - start;
+                decode_time += stop - mid;
+            }
+
+            auto bytes = iterations * original.size();
+            TEST(decompressed == original);
+            std::println("... {} {} ratio = {:.4f}", codec_name, name,
+                static_cast<double>(compressed.size()) / static_cast<double>(original.size()));
+            std::println("... {} {} encode MB per second = {:.1f}", codec_name, name, mb_per_second(bytes, encode_time));
+            std::println("... {} {} decode MB per second = {:.1f}", codec_name, name, mb_per_second(bytes, decode_time));
+
+        }
+
+    }
+
 }
 
 void test_rs_core_compress_single_block() {
@@ -94,3 +140,490 @@ void test_rs_core_compress_multiple_blocks() {
     TEST(view.empty());
 
 }
+
+void test_rs_core_compress_stream_encode() {
+
+    std::string original, compressed, decompressed;
+    std::vector<std::size_t> sinks;
+    Pcg rng {42};
+    Zlib z;
+    Zlib::result res;
+
+    original = generate_text(1'234'567, rng);
+
+    {
+
+        ZlibStream zs {ZlibStream::encode, [&] (std::string_view block) {
+            sinks.push_back(block.size());
+            compressed += block;
+        }, -1, 10'000};
+
+        std::string_view view {original};
+
+        while (! view.empty()) {
+            auto n = std::min(view.size(), static_cast<std::size_t>(rng() % 20'000));
+            TEST_EQUAL(zs.write(view.substr(0, n)), n);
+            view = view.substr(n);
+        }
+
+        TEST(! zs.done());
+        TRY(zs.finish());
+        TEST(zs.done());
+        TEST_EQUAL(zs.bytes_in(), original.size());
+        TEST_EQUAL(zs.bytes_out(), compressed.size());
+        TEST_THROW(zs.write(original), Zlib::error, "finished");
+
+    }
+
+    TEST(std::ranges::all_of(sinks, [] (auto n) { return n > 0 && n <= 10'000; }));
+    TRY(res = z.decode(compressed, decompressed));
+    TEST_EQUAL(res.bytes_in, compressed.size());
+    TEST(decompressed == original);
+
+    // Flush points make everything written so far decodable
+
+    compressed.clear();
+    decompressed.clear();
+    StringBuffer buf {compressed};
+
+    {
+
+        ZlibStream zs {ZlibStream::encode, buf};
+        TRY(zs.write(std::string_view{"Hello world\n"}));
+        TRY(zs.flush());
+        TEST(! compressed.empty());
+
+        ZlibStream dec {ZlibStream::decode, [&] (std::string_view block) { decompressed += block; }};
+        TRY(dec.write(compressed));
+        TRY(dec.flush());
+        TEST_EQUAL(decompressed, "Hello world\n");
+        TEST(! dec.done());
+
+        TRY(zs.write(std::string_view{"Goodnight moon\n"}));
+        TRY(zs.finish());
+
+    }
+
+    decompressed.clear();
+    TRY(z.decode(compressed, decompressed));
+    TEST_EQUAL(decompressed, "Hello world\nGoodnight moon\n");
+
+}
+
+void test_rs_core_compress_stream_decode() {
+
+    std::string original, compressed, decompressed;
+    Pcg rng {42};
+    Zlib z;
+    auto n = 0uz;
+
+    original = generate_text(1'234'567, rng);
+    TRY(z.encode(original, compressed));
+    auto size = compressed.size();
+    compressed += "trailing data";
+
+    {
+
+        ZlibStream zs {ZlibStream::decode, [&] (std::string_view block) {
+            TEST(block.size() <= 4096u);
+            decompressed += block;
+        }, -1, 4096};
+
+        std::string_view view {compressed};
+        auto total = 0uz;
+
+        while (! zs.done() && ! view.empty()) {
+            auto len = std::min(view.size(), static_cast<std::size_t>(rng() % 5000));
+            TRY(n = zs.write(view.substr(0, len)));
+            total += n;
+            view = view.substr(n);
+        }
+
+        TEST(zs.done());
+        TEST_EQUAL(total, size);
+        TEST_EQUAL(view, "trailing data");
+        TRY(n = zs.write(view));
+        TEST_EQUAL(n, 0u);
+        TRY(zs.finish());
+        TEST_EQUAL(zs.bytes_in(), size);
+        TEST_EQUAL(zs.bytes_out(), original.size());
+
+    }
+
+    TEST(decompressed == original);
+
+    {
+        ZlibStream zs {ZlibStream::decode, [] (std::string_view) {}};
+        TRY(zs.write(std::string_view(compressed).substr(0, size / 2)));
+        TEST_THROW(zs.finish(), Zlib::error, "incomplete");
+    }
+
+    {
+        ZlibStream zs {ZlibStream::decode, [] (std::string_view) {}};
+        TEST_THROW(zs.write(std::string_view{"not compressed data"}), Zlib::error, "Z_DATA_ERROR");
+    }
+
+}
+
+void test_rs_core_compress_parallel_encode() {
+
+    ThreadPool pool {4};
+    std::string original, compressed, serial, decompressed;
+    Pcg rng {42};
+    Zlib z;
+    Zlib::result res;
+
+    for (auto size: {0uz, 100uz, 200'000uz, 1'000'000uz, 5'678'999uz}) {
+
+        original = generate_text(size, rng);
+
+        // Make some of it repetitive, so that matches cross block boundaries
+
+        for (auto i = 0uz; i + 100 < original.size(); i += 1000) {
+            original.replace(i, 100, original, 0, 100);
+        }
+
+        for (auto level: {-1, 1, 9}) {
+
+            compressed = "xyz";
+            TRY(res = z.encode(original, compressed, level, pool, 64 * 1024));
+            TEST_EQUAL(res.bytes_in, original.size());
+            TEST_EQUAL(res.bytes_out, compressed.size() - 3);
+            decompressed.clear();
+            TRY(res = z.decode(std::string_view{compressed}.substr(3), decompressed));
+            TEST_EQUAL(res.bytes_in, compressed.size() - 3);
+            TEST(decompressed == original);
+
+            serial.clear();
+            TRY(z.encode(original, serial, level));
+
+            if (size <= 64 * 1024) {
+                TEST(compressed.substr(3) == serial);
+            } else {
+                TEST(compressed.size() < serial.size() * 102 / 100);
+            }
+
+        }
+
+    }
+
+    original = generate_text(1'000'000, rng);
+    compressed.clear();
+    decompressed.clear();
+    TRY(z.encode(original, compressed, pool));
+    TRY(z.decode(compressed, decompressed));
+    TEST(decompressed == original);
+
+}
+
+void test_rs_core_compress_size_hint() {
+
+    std::string original, compressed, decompressed;
+    Pcg rng {42};
+    Zlib z;
+    Zlib::result res;
+
+    original = generate_text(1'234'567, rng);
+    TRY(z.encode(original, compressed));
+
+    for (auto hint: {0uz, 1uz, 1000uz, original.size() - 1, original.size(), original.size() * 2}) {
+        decompressed = "xyz";
+        TRY(res = z.decode(compressed, decompressed, hint));
+        TEST_EQUAL(res.bytes_in, compressed.size());
+        TEST_EQUAL(res.bytes_out, original.size());
+        TEST_EQUAL(decompressed.size(), original.size() + 3);
+        TEST(decompressed.substr(3) == original);
+    }
+
+    // Highly compressible data needs many times the guessed output size
+
+    original.assign(10'000'000, 'x');
+    compressed.clear();
+    TRY(z.encode(original, compressed));
+    TEST(compressed.size() < 20'000);
+    decompressed.clear();
+    TRY(res = z.decode(compressed, decompressed));
+    TEST_EQUAL(res.bytes_out, original.size());
+    TEST(decompressed == original);
+
+    std::vector<unsigned char> bytes;
+    TRY(res = z.decode(compressed, bytes, 100));
+    TEST_EQUAL(res.bytes_out, original.size());
+    TEST(std::ranges::all_of(bytes, [] (unsigned char c) { return c == 'x'; }));
+
+    // Incomplete input
+
+    decompressed = "xyz";
+    TEST_THROW(z.decode(std::string_view{compressed}.substr(0, compressed.size() / 2), decompressed),
+        Zlib::error, "incomplete");
+    TEST_EQUAL(decompressed, "xyz");
+
+}
+
+void test_rs_core_compress_lz4() {
+
+    static_assert(Codec<Zlib>);
+    static_assert(Codec<Lz4>);
+
+    std::string original, compressed, decompressed;
+    std::vector<std::size_t> sizes;
+    Pcg rng {42};
+    Lz4 lz;
+    Lz4::result res;
+
+    for (auto size: {0uz, 1uz, 12uz, 13uz, 100uz, 65'536uz, 1'234'567uz}) {
+
+        original = generate_text(size, rng);
+
+        for (auto i = 0uz; i + 100 < original.size(); i += 1000) {
+            original.replace(i, 100, original, 0, 100);
+        }
+
+        compressed = "xyz";
+        TRY(res = lz.encode(original, compressed));
+        TEST_EQUAL(res.bytes_in, original.size());
+        TEST_EQUAL(res.bytes_out, compressed.size() - 3);
+        TEST(res.bytes_out <= Lz4::max_encoded_size(size));
+        sizes.push_back(res.bytes_out);
+        decompressed = "abc";
+        TRY(res = lz.decode(std::string_view{compressed}.substr(3), decompressed));
+        TEST_EQUAL(res.bytes_in, compressed.size() - 3);
+        TEST_EQUAL(res.bytes_out, original.size());
+        TEST(decompressed.substr(3) == original);
+
+    }
+
+    TEST(sizes.back() < 1'234'567 * 95 / 100);
+
+    // Highly compressible data, and overlapping matches
+
+    for (auto& ori: {std::string(10'000'000, 'x'), std::string(100'000, 'x') + "abcabcabcabcabcabcabcabcabcabc"}) {
+        compressed.clear();
+        decompressed.clear();
+        TRY(lz.encode(ori, compressed));
+        TEST(compressed.size() < ori.size() / 100);
+        TRY(lz.decode(compressed, decompressed));
+        TEST(decompressed == ori);
+    }
+
+    // Concatenated streams
+
+    std::vector<std::string> parts {"Hello world", generate_text(100'000, rng), "", "Goodbye"};
+    std::vector<unsigned char> bytes;
+
+    compressed.clear();
+
+    for (auto& part: parts) {
+        TRY(lz.encode(part, compressed));
+    }
+
+    std::string_view view {compressed};
+
+    for (auto& part: parts) {
+        bytes.clear();
+        TRY(res = lz.decode(view, bytes));
+        TEST_EQUAL(res.bytes_out, part.size());
+        TEST(std::ranges::equal(bytes, part, [] (unsigned char a, char b) { return a == static_cast<unsigned char>(b); }));
+        view = view.substr(res.bytes_in);
+    }
+
+    TEST(view.empty());
+
+    // Incomplete and corrupt input
+
+    original = generate_text(10'000, rng);
+    compressed.clear();
+    TRY(lz.encode(original, compressed));
+
+    decompressed = "xyz";
+    TEST_THROW(lz.decode(std::string_view{compressed}.substr(0, compressed.size() - 1), decompressed),
+        Lz4::error, "incomplete");
+    TEST_EQUAL(decompressed, "xyz");
+    TEST_THROW(lz.decode(std::string_view{}, decompressed), Lz4::error, "incomplete");
+    TEST_THROW(lz.decode(std::string_view{"\xff\xff\xff\xff\xff\xff\xff\x7f"}, decompressed), Lz4::error, "corrupt");
+
+    for (int i = 0; i < 1000; ++i) {
+        auto damaged = compressed;
+        damaged[rng() % damaged.size()] = static_cast<char>(rng());
+        decompressed.clear();
+        try {
+            lz.decode(damaged, decompressed);
+            TEST_EQUAL(decompressed.size(), original.size());
+        }
+        catch (const Lz4::error&) {
+            TEST(decompressed.empty());
+        }
+    }
+
+}
+
+void test_rs_core_compress_context() {
+
+    static_assert(Codec<ZlibContext>);
+
+    std::string original, compressed, decompressed, expect;
+    Pcg rng {42};
+    Zlib z;
+    ZlibContext zc;
+    Zlib::result res;
+
+    TEST_EQUAL(zc.level(), -1);
+    TEST(zc.dictionary().empty());
+    TEST_THROW(ZlibContext(10), Zlib::error, "Invalid compression level");
+
+    // Without a dictionary, a reused context produces the same output as
+    // the stateless functions
+
+    for (auto size: {0uz, 10uz, 1000uz, 123'456uz, 10uz}) {
+
+        original = generate_text(size, rng);
+        compressed = "xyz";
+        expect.clear();
+        TRY(res = zc.encode(original, compressed));
+        TEST_EQUAL(res.bytes_in, original.size());
+        TEST_EQUAL(res.bytes_out, compressed.size() - 3);
+        TRY(z.encode(original, expect));
+        TEST(compressed.substr(3) == expect);
+
+        decompressed.clear();
+        TRY(res = zc.decode(std::string_view{compressed}.substr(3), decompressed));
+        TEST_EQUAL(res.bytes_in, compressed.size() - 3);
+        TEST(decompressed == original);
+
+    }
+
+    // A failed call does not affect the next one
+
+    decompressed = "abc";
+    TEST_THROW(zc.decode(std::string_view{compressed}.substr(3, 5), decompressed), Zlib::error, "incomplete");
+    TEST_EQUAL(decompressed, "abc");
+    decompressed.clear();
+    TRY(zc.decode(std::string_view{compressed}.substr(3), decompressed));
+    TEST(decompressed == original);
+
+    // Preset dictionary
+
+    std::string dictionary = "The quick brown fox jumps over the lazy dog";
+    original = "The lazy dog jumps over the quick brown fox";
+    ZlibContext with_dict {9, dictionary};
+    ZlibContext wrong_dict {9, "Hello world"};
+    std::string plain;
+
+    TEST_EQUAL(with_dict.dictionary(), dictionary);
+    TRY(zc.encode(original, plain));
+
+    for (int i = 0; i < 3; ++i) {
+        compressed.clear();
+        TRY(with_dict.encode(original, compressed));
+        TEST(compressed.size() < plain.size());
+        decompressed.clear();
+        TRY(res = with_dict.decode(compressed, decompressed));
+        TEST_EQUAL(res.bytes_in, compressed.size());
+        TEST_EQUAL(decompressed, original);
+    }
+
+    decompressed.clear();
+    TEST_THROW(z.decode(compressed, decompressed), Zlib::error, "Preset dictionary expected");
+    TEST_THROW(zc.decode(compressed, decompressed), Zlib::error, "Preset dictionary expected");
+    TEST_THROW(wrong_dict.decode(compressed, decompressed), Zlib::error, "Preset dictionary does not match");
+    TEST(decompressed.empty());
+
+    // Only the last 32k of a long dictionary is used
+
+    std::string long_dict = generate_text(100'000, rng);
+    ZlibContext long_context {-1, long_dict};
+    TEST_EQUAL(long_context.dictionary().size(), ZlibContext::max_dictionary);
+    TEST(long_context.dictionary() == std::string_view{long_dict}.substr(100'000 - ZlibContext::max_dictionary));
+    original = long_dict.substr(90'000, 5000);
+    compressed.clear();
+    decompressed.clear();
+    TRY(long_context.encode(original, compressed));
+    TEST(compressed.size() < 100);
+    TRY(long_context.decode(compressed, decompressed));
+    TEST(decompressed == original);
+
+}
+
+void test_rs_core_compress_benchmark() {
+
+    static constexpr auto size = 20'000'000uz;
+
+    Pcg rng {42};
+
+    auto text = generate_text(size, rng);
+
+    for (auto i = 0uz; i + 100 < text.size(); i += 1000) {
+        text.replace(i, 100, text, 0, 100);
+    }
+
+    std::string random(size, '\0');
+
+    for (auto& c: random) {
+        c = static_cast<char>(rng());
+    }
+
+    const std::vector<std::pair<std::string_view, std::string>> corpus = {
+        {"zeros", std::string(size, '\0')},
+        {"text", std::move(text)},
+        {"random", std::move(random)},
+    };
+
+    Zlib zlib1 {1};
+    Zlib zlib6 {6};
+    Lz4 lz4;
+
+    run_codec_benchmark("zlib 1", zlib1, corpus);
+    run_codec_benchmark("zlib 6", zlib6, corpus);
+    run_codec_benchmark("lz4", lz4, corpus);
+
+    // Many small messages with a common vocabulary
+
+    static constexpr int messages = 100'000;
+
+    std::vector<std::string> small(100);
+    std::string dictionary;
+
+    auto make_message = [&rng] (std::string_view name) {
+        return R"({"id":)" + std::to_string(rng() % 100'000) + R"(,"name":")" + std::string{name}
+            + R"(","status":"active","tags":["alpha","beta"],"score":)" + std::to_string(rng() % 1000) + "}";
+    };
+
+    for (auto& msg: small) {
+        msg = make_message(generate_text(8, rng));
+    }
+
+    for (int i = 0; i < 10; ++i) {
+        dictionary += make_message("");
+    }
+
+    ZlibContext context {6};
+    ZlibContext dict_context {6, dictionary};
+
+    auto run_small = [&] (std::string_view codec_name, auto& codec) {
+        std::string compressed, decompressed;
+        auto bytes_in = 0uz;
+        auto bytes_out = 0uz;
+        auto start = system_clock::now();
+        for (int i = 0; i < messages; ++i) {
+            auto& msg = small[static_cast<std::size_t>(i) % small.size()];
+            compressed.clear();
+            decompressed.clear();
+            TRY(codec.encode(msg, compressed));
+            TRY(codec.decode(compressed, decompressed));
+            bytes_in += msg.size();
+            bytes_out += compressed.size();
+        }
+        auto stop = system_clock::now();
+        TEST(decompressed == small[(messages - 1) % small.size()]);
+        auto rate = static_cast<double>(messages) / duration_cast<duration<double>>(stop - start).count();
+        std::println("... {} small message ratio = {:.4f}", codec_name,
+            static_cast<double>(bytes_out) / static_cast<double>(bytes_in));
+        std::println("... {} small messages per second = {:.0f}", codec_name, rate);
+    };
+
+    run_small("zlib 6", zlib6);
+    run_small("zlib context", context);
+    run_small("zlib dictionary", dict_context);
+    run_small("lz4", lz4);
+
+}
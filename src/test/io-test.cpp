@@ -1,10 +1,21 @@
 #include "rs-core/io.hpp"
 #include "rs-core/unit-test.hpp"
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <print>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <system_error>
+#include <thread>
+#include <vector>
 
 using namespace RS;
+using namespace std::chrono;
 
 namespace fs = std::filesystem;
 
@@ -437,3 +448,708 @@ void test_rs_core_io_string_buffer_line_iterator() {
     }
 
 }
+
+void test_rs_core_io_buffered_line_views() {
+
+    std::string text =
+        "Hello world\n"
+        "\n"
+        "Goodnight moon\r\n"
+        "A line much longer than the buffer it is read through\n"
+        "No line feed";
+
+    std::vector<std::string> lines;
+
+    for (auto size: {1uz, 4uz, 16uz, BufferedIO::default_buffer_size}) {
+
+        {
+            StringBuffer sb(text);
+            BufferedIO io(sb, size);
+            lines.clear();
+            for (auto line: io.line_views()) {
+                lines.push_back(std::string{line});
+            }
+            TEST_EQUAL(lines.size(), 5u);
+            if (lines.size() == 5) {
+                TEST_EQUAL(lines[0], "Hello world\n");
+                TEST_EQUAL(lines[1], "\n");
+                TEST_EQUAL(lines[2], "Goodnight moon\r\n");
+                TEST_EQUAL(lines[3], "A line much longer than the buffer it is read through\n");
+                TEST_EQUAL(lines[4], "No line feed");
+            }
+        }
+
+        {
+            StringBuffer sb(text);
+            BufferedIO io(sb, size);
+            lines.clear();
+            for (auto line: io.line_views(true)) {
+                lines.push_back(std::string{line});
+            }
+            TEST_EQUAL(lines.size(), 5u);
+            if (lines.size() == 5) {
+                TEST_EQUAL(lines[0], "Hello world");
+                TEST_EQUAL(lines[1], "");
+                TEST_EQUAL(lines[2], "Goodnight moon");
+                TEST_EQUAL(lines[3], "A line much longer than the buffer it is read through");
+                TEST_EQUAL(lines[4], "No line feed");
+            }
+        }
+
+        {
+            StringBuffer sb(text);
+            BufferedIO io(sb, size);
+            lines.clear();
+            for (auto& line: io.lines()) {
+                lines.push_back(line);
+            }
+            TEST_EQUAL(lines.size(), 5u);
+            if (lines.size() == 5) {
+                TEST_EQUAL(lines[2], "Goodnight moon\r\n");
+                TEST_EQUAL(lines[4], "No line feed");
+            }
+        }
+
+    }
+
+    {
+        Cstdio out(test_file, IO::write_only);
+        TRY(out.write_str(text));
+    }
+
+    {
+        Cstdio in(test_file);
+        BufferedIO io(in, 8);
+        std::string_view line;
+        TRY(line = io.read_line_view(true));
+        TEST_EQUAL(line, "Hello world");
+        TRY(line = io.read_line_view(true));
+        TEST_EQUAL(line, "");
+        TEST(line.data() != nullptr);
+        TRY(line = io.read_line_view(true));
+        TEST_EQUAL(line, "Goodnight moon");
+        TRY(line = io.read_line_view(true));
+        TEST_EQUAL(line, "A line much longer than the buffer it is read through");
+        TRY(line = io.read_line_view(true));
+        TEST_EQUAL(line, "No line feed");
+        TRY(line = io.read_line_view(true));
+        TEST(line.empty());
+        TEST(line.data() == nullptr);
+    }
+
+    TRY(fs::remove(test_file));
+    TEST(! fs::exists(test_file));
+
+}
+
+void test_rs_core_io_buffered_mixed_io() {
+
+    std::string text = "abcdefghijklmnopqrstuvwxyz\n0123456789\n";
+    std::string s;
+    std::string_view v;
+    char c{};
+    auto n = 0uz;
+
+    {
+        StringBuffer sb(text);
+        BufferedIO io(sb, 8);
+        TEST(io.can_seek());
+        TEST(! io.is_tty());
+        TEST(io.base() == &sb);
+        TEST(io.get(c));
+        TEST_EQUAL(c, 'a');
+        TEST_EQUAL(io.tell(), 1);
+        TEST_EQUAL(io.buffered(), 7u);
+        TRY(s = io.read_str(4));
+        TEST_EQUAL(s, "bcde");
+        TEST_EQUAL(io.tell(), 5);
+        TRY(s = io.read_str(10));
+        TEST_EQUAL(s, "fghijklmno");
+        TEST_EQUAL(io.tell(), 15);
+        TRY(v = io.read_line_view());
+        TEST_EQUAL(v, "pqrstuvwxyz\n");
+        TEST_EQUAL(io.tell(), 27);
+        TRY(io.seek(-5, IO::current));
+        TEST_EQUAL(io.tell(), 22);
+        TRY(s = io.read_line());
+        TEST_EQUAL(s, "wxyz\n");
+        TRY(io.seek(0, IO::set));
+        TRY(s = io.read_all());
+        TEST_EQUAL(s, text);
+        TRY(n = io.read(&c, 1));
+        TEST_EQUAL(n, 0u);
+    }
+
+    {
+        Cstdio out(test_file, IO::write_only);
+        TRY(out.write_str(text));
+    }
+
+    {
+        Cstdio in(test_file, IO::read_write);
+        BufferedIO io(in, 16);
+        TRY(v = io.read_line_view(true));
+        TEST_EQUAL(v, "abcdefghijklmnopqrstuvwxyz");
+        TRY(io.get(c));
+        TEST_EQUAL(c, '0');
+        TRY(io.write_str("ONE"));
+        TRY(io.flush());
+        TRY(io.seek(0, IO::set));
+        TRY(s = io.read_all());
+        TEST_EQUAL(s, "abcdefghijklmnopqrstuvwxyz\n0ONE456789\n");
+    }
+
+    {
+        // Closing the adaptor leaves the underlying stream open, at the
+        // logical read position
+
+        StringBuffer sb(text);
+        BufferedIO io(sb, 8);
+        TRY(s = io.read_str(3));
+        TEST_EQUAL(s, "abc");
+        TEST_EQUAL(io.buffered(), 5u);
+        TRY(io.close());
+        TEST(io.base() == nullptr);
+        TEST_EQUAL(io.buffered(), 0u);
+        TEST(! io.get(c));
+        TEST_EQUAL(sb.tell(), 3);
+        TRY(s = sb.read_str(3));
+        TEST_EQUAL(s, "def");
+    }
+
+    {
+        BufferedIO io;
+        TEST(! io.can_seek());
+        TEST(io.base() == nullptr);
+        TEST(! io.get(c));
+        TRY(n = io.read(&c, 1));
+        TEST_EQUAL(n, 0u);
+        TRY(v = io.read_line_view());
+        TEST(v.data() == nullptr);
+        TEST_EQUAL(io.tell(), 0);
+        TEST_THROW(io.put('a'), std::system_error, "");
+        TEST_THROW(io.write_str("Hello"), std::system_error, "");
+        TEST_THROW(io.seek(0, IO::set), std::system_error, "");
+        TRY(io.flush());
+        TRY(io.close());
+    }
+
+    TRY(fs::remove(test_file));
+    TEST(! fs::exists(test_file));
+
+}
+
+void test_rs_core_io_line_benchmark() {
+
+    static constexpr int line_count = 500'000;
+
+    {
+        Cstdio out(test_file, IO::write_only);
+        for (int i = 0; i < line_count; ++i) {
+            TRY(out.print("Line number {} with some padding to make it a typical length\n", i));
+        }
+    }
+
+    auto run = [] (const char* name, auto read_lines) {
+        Cstdio in(test_file);
+        auto start = system_clock::now();
+        auto bytes = read_lines(in);
+        auto stop = system_clock::now();
+        auto total = duration_cast<duration<double>>(stop - start).count();
+        auto rate = static_cast<std::uint64_t>(static_cast<double>(bytes) / total / 1e6);
+        std::println("... {} = {} MB/s", name, rate);
+    };
+
+    run("Cstdio::lines()", [] (Cstdio& in) {
+        auto bytes = 0uz;
+        for (auto& line: in.lines()) {
+            bytes += line.size();
+        }
+        return bytes;
+    });
+
+    run("IO::read_full_line()", [] (Cstdio& in) {
+        auto bytes = 0uz;
+        for (auto line = in.IO::read_full_line(); ! line.empty(); line = in.IO::read_full_line()) {
+            bytes += line.size();
+        }
+        return bytes;
+    });
+
+    run("BufferedIO::line_views()", [] (Cstdio& in) {
+        BufferedIO io(in);
+        auto bytes = 0uz;
+        for (auto line: io.line_views()) {
+            bytes += line.size();
+        }
+        return bytes;
+    });
+
+    run("MmapFile::line_views()", [] (Cstdio&) {
+        MmapFile io(test_file, MmapFile::access::sequential);
+        auto bytes = 0uz;
+        for (auto line: io.line_views()) {
+            bytes += line.size();
+        }
+        return bytes;
+    });
+
+    TRY(fs::remove(test_file));
+
+}
+
+void test_rs_core_io_mmap_file_class() {
+
+    std::string text = "Hello world\nGoodnight moon\nHere comes the sun\n";
+    std::string s;
+    std::string_view v;
+    char c{};
+    auto n = 0uz;
+
+    {
+        Cstdio out(test_file, IO::write_only);
+        TRY(out.write_str(text));
+    }
+
+    {
+        MmapFile io;
+        TRY(io = MmapFile(test_file, MmapFile::access::sequential));
+        TEST(! io.empty());
+        TEST_EQUAL(io.size(), 46u);
+        TEST_EQUAL(io.view(), text);
+        TEST(io.can_seek());
+        TEST(! io.is_tty());
+        TEST_EQUAL(io.tell(), 0);
+        TEST(io.get(c));
+        TEST_EQUAL(c, 'H');
+        TRY(s = io.read_str(10));
+        TEST_EQUAL(s, "ello world");
+        TEST_EQUAL(io.tell(), 11);
+        TRY(s = io.read_line());
+        TEST_EQUAL(s, "\n");
+        TRY(io.seek(-19, IO::end));
+        TRY(s = io.read_all());
+        TEST_EQUAL(s, "Here comes the sun\n");
+        TRY(n = io.read(&c, 1));
+        TEST_EQUAL(n, 0u);
+        TEST(! io.get(c));
+        TRY(io.seek(5, IO::set));
+        TRY(io.advise(MmapFile::access::random));
+        TRY(s = io.read_str(100));
+        TEST_EQUAL(s, text.substr(5));
+        TEST_THROW(io.write_str("Hello"), std::system_error, "");
+        TRY(v = io.view());
+        TRY(io.close());
+        TEST(io.empty());
+        TEST_EQUAL(io.view(), "");
+    }
+
+    {
+        Cstdio out(test_file, IO::write_only);
+    }
+
+    {
+        MmapFile io(test_file);
+        TEST(io.empty());
+        TEST_EQUAL(io.view(), "");
+        TRY(s = io.read_all());
+        TEST_EQUAL(s, "");
+        TEST(! io.get(c));
+    }
+
+    TRY(fs::remove(test_file));
+    TEST(! fs::exists(test_file));
+    TEST_THROW(MmapFile(test_file), std::system_error, test_file.string());
+
+    // Devices and directories are not regular files, even though they
+    // report a size of zero
+
+    TEST_THROW(MmapFile("/dev/null"), std::system_error, "/dev/null");
+    TEST_THROW(MmapFile("."), std::system_error, "");
+
+}
+
+void test_rs_core_io_mmap_file_line_views() {
+
+    std::string text = "Hello world\n\nGoodnight moon\r\nNo line feed";
+    std::vector<std::string_view> views;
+    std::vector<std::string> lines;
+
+    {
+        Cstdio out(test_file, IO::write_only);
+        TRY(out.write_str(text));
+    }
+
+    {
+        MmapFile io(test_file);
+        for (auto line: io.line_views()) {
+            views.push_back(line);
+        }
+        TEST_EQUAL(views.size(), 4u);
+        if (views.size() == 4) {
+            TEST_EQUAL(views[0], "Hello world\n");
+            TEST_EQUAL(views[1], "\n");
+            TEST_EQUAL(views[2], "Goodnight moon\r\n");
+            TEST_EQUAL(views[3], "No line feed");
+            TEST(views[0].data() == io.view().data());
+        }
+        TRY(io.seek(0, IO::set));
+        views.clear();
+        for (auto line: io.line_views(true)) {
+            views.push_back(line);
+        }
+        TEST_EQUAL(views.size(), 4u);
+        if (views.size() == 4) {
+            TEST_EQUAL(views[0], "Hello world");
+            TEST_EQUAL(views[1], "");
+            TEST_EQUAL(views[2], "Goodnight moon");
+            TEST_EQUAL(views[3], "No line feed");
+        }
+        TRY(io.seek(0, IO::set));
+        for (auto& line: io.lines(true)) {
+            lines.push_back(line);
+        }
+        TEST_EQUAL(lines.size(), 4u);
+        if (lines.size() == 4) {
+            TEST_EQUAL(lines[1], "");
+            TEST_EQUAL(lines[2], "Goodnight moon");
+        }
+    }
+
+    TRY(fs::remove(test_file));
+    TEST(! fs::exists(test_file));
+
+}
+
+void test_rs_core_io_fdio_class() {
+
+    std::string s;
+    auto n = 0uz;
+    auto z = 0z;
+
+    {
+        Fdio io(test_file, IO::write_only);
+        TEST(io.handle() > 2);
+        TRY(n = io.write_str("Hello world\n"));
+        TEST_EQUAL(n, 12u);
+        TRY(n = io.write_str("Goodnight moon\n"));
+        TEST_EQUAL(n, 15u);
+        TRY(io.put('X'));
+        TRY(io.print("{} {}\n", 42, "abc"));
+    }
+
+    {
+        Fdio io(test_file, IO::append);
+        TRY(io.write_str("Here comes the sun\n"));
+    }
+
+    {
+        Fdio io(test_file);
+        TEST(io.can_seek());
+        TEST(! io.is_tty());
+        TRY(z = io.tell());
+        TEST_EQUAL(z, 0);
+        TRY(io.seek(0, IO::end));
+        TRY(z = io.tell());
+        TEST_EQUAL(z, 54);
+        TRY(io.seek(12, IO::set));
+        TRY(s = io.read_line());
+        TEST_EQUAL(s, "Goodnight moon\n");
+        TRY(s = io.read_str(8));
+        TEST_EQUAL(s, "X42 abc\n");
+        TRY(io.seek(0, IO::set));
+        TRY(s = io.read_all());
+        TEST_EQUAL(s, "Hello world\nGoodnight moon\nX42 abc\nHere comes the sun\n");
+        TRY(s = io.read_str(10));
+        TEST_EQUAL(s, "");
+        TEST_THROW(io.write_str("Hello"), std::system_error, "");
+    }
+
+    {
+        Fdio io1(test_file);
+        Fdio io2;
+        auto fd = io1.handle();
+        TRY(io2 = std::move(io1));
+        TEST_EQUAL(io1.handle(), -1);
+        TEST_EQUAL(io2.handle(), fd);
+        TRY(s = io2.read_str(5));
+        TEST_EQUAL(s, "Hello");
+        TEST_EQUAL(io2.release(), fd);
+        TEST_EQUAL(io2.handle(), -1);
+        Fdio io3(fd, true);
+        TRY(io3.close());
+        TEST_EQUAL(io3.handle(), -1);
+    }
+
+    TEST_THROW(Fdio(0, true), std::invalid_argument, "standard stream");
+
+    {
+        Fdio io("-", IO::read_only);
+        TEST_EQUAL(io.handle(), 0);
+        Fdio out("-", IO::write_only);
+        TEST_EQUAL(out.handle(), 1);
+    }
+
+    TRY(fs::remove(test_file));
+    TEST(! fs::exists(test_file));
+    TEST_THROW(Fdio(test_file), std::system_error, test_file.string());
+
+}
+
+void test_rs_core_io_fdio_vector_io() {
+
+    std::string header = "HEADER:";
+    std::string payload = "The quick brown fox\n";
+    std::string s;
+    auto n = 0uz;
+
+    {
+        Fdio io(test_file, IO::write_only);
+        std::array<std::string_view, 4> parts {{header, "", payload, "END\n"}};
+        TRY(n = io.writev(parts));
+        TEST_EQUAL(n, 31u);
+        std::vector<std::string_view> many(2000, "ab");
+        TRY(n = io.writev(many));
+        TEST_EQUAL(n, 4000u);
+    }
+
+    {
+        Fdio io(test_file);
+        std::string a(7, '\0');
+        std::string b(20, '\0');
+        std::string c(10, '\0');
+        std::array<std::span<char>, 3> parts {{a, b, c}};
+        TRY(n = io.readv(parts));
+        TEST_EQUAL(n, 37u);
+        TEST_EQUAL(a, "HEADER:");
+        TEST_EQUAL(b, "The quick brown fox\n");
+        TEST_EQUAL(c, "END\nababab");
+        std::string d(5000, '\0');
+        std::array<std::span<char>, 1> rest {{d}};
+        TRY(n = io.readv(rest));
+        TEST_EQUAL(n, 3994u);
+        TRY(n = io.readv(rest));
+        TEST_EQUAL(n, 0u);
+    }
+
+    TRY(fs::remove(test_file));
+    TEST(! fs::exists(test_file));
+
+}
+
+void test_rs_core_io_fdio_positional_io() {
+
+    static constexpr auto block_size = 4096uz;
+    static constexpr auto blocks = 64uz;
+    static constexpr auto thread_count = 4uz;
+
+    {
+        Fdio io(test_file, IO::write_only);
+        std::vector<std::jthread> threads;
+        for (auto t = 0uz; t < thread_count; ++t) {
+            threads.emplace_back([&io, t] {
+                std::string block(block_size, '\0');
+                for (auto i = t; i < blocks; i += thread_count) {
+                    std::ranges::fill(block, static_cast<char>('A' + i % 26));
+                    io.pwrite(block.data(), block.size(), static_cast<std::ptrdiff_t>(i * block_size));
+                }
+            });
+        }
+    }
+
+    TEST_EQUAL(fs::file_size(test_file), block_size * blocks);
+
+    {
+        Fdio io(test_file);
+        std::vector<int> errors(thread_count, 0);
+        std::vector<std::jthread> threads;
+        for (auto t = 0uz; t < thread_count; ++t) {
+            threads.emplace_back([&io, &errors, t] {
+                std::string block(block_size, '\0');
+                for (auto j = t; j < blocks; j += thread_count) {
+                    auto i = blocks - 1 - j;
+                    auto n = io.pread(block.data(), block.size(), static_cast<std::ptrdiff_t>(i * block_size));
+                    if (n != block_size || block != std::string(block_size, static_cast<char>('A' + i % 26))) {
+                        ++errors[t];
+                    }
+                }
+            });
+        }
+        threads.clear();
+        for (auto e: errors) {
+            TEST_EQUAL(e, 0);
+        }
+        TEST_EQUAL(io.tell(), 0);
+        std::string s(10, '\0');
+        TEST_EQUAL(io.pread(s.data(), s.size(), static_cast<std::ptrdiff_t>(block_size * blocks - 4)), 4u);
+        TEST_EQUAL(s.substr(0, 4), std::string(4, static_cast<char>('A' + (blocks - 1) % 26)));
+    }
+
+    TRY(fs::remove(test_file));
+    TEST(! fs::exists(test_file));
+
+}
+
+namespace {
+
+    // Writes the data into a pipe from another thread, and returns the read
+    // end of the pipe
+
+    Fdio pipe_from(const std::string& data, std::jthread& writer) {
+        int fds[2];
+        if (::pipe(fds) == -1) {
+            throw std::system_error(std::error_code(errno, std::system_category()));
+        }
+        writer = std::jthread([fd = fds[1], &data] {
+            Fdio out(fd);
+            out.write_str(data);
+        });
+        return Fdio(fds[0]);
+    }
+
+}
+
+void test_rs_core_io_read_all_into() {
+
+    std::string data;
+    std::string buf;
+    auto n = 0uz;
+
+    for (auto i = 0; i < 100'000; ++i) {
+        data += std::format("{}\n", i);
+    }
+
+    {
+        Cstdio out(test_file, IO::write_only);
+        TRY(out.write_str(data));
+    }
+
+    {
+        Cstdio in(test_file);
+        TRY(n = in.read_all_into(buf));
+        TEST_EQUAL(n, data.size());
+        TEST(buf == data);
+        auto capacity = buf.capacity();
+        auto ptr = buf.data();
+        TRY(in.seek(-10, IO::end));
+        TRY(n = in.read_all_into(buf));
+        TEST_EQUAL(n, 10u);
+        TEST_EQUAL(buf, data.substr(data.size() - 10));
+        TEST_EQUAL(buf.capacity(), capacity);
+        TEST(buf.data() == ptr);
+        TRY(n = in.read_all_into(buf));
+        TEST_EQUAL(n, 0u);
+        TEST(buf.empty());
+    }
+
+    {
+        Fdio in(test_file);
+        TRY(in.seek(100, IO::set));
+        TRY(n = in.read_all_into(buf));
+        TEST_EQUAL(n, data.size() - 100);
+        TEST(buf == data.substr(100));
+    }
+
+    {
+        MmapFile in(test_file);
+        TRY(in.seek(200, IO::set));
+        TRY(n = in.read_all_into(buf));
+        TEST_EQUAL(n, data.size() - 200);
+        TEST(buf == data.substr(200));
+    }
+
+    {
+        StringBuffer in(data);
+        TRY(in.seek(300, IO::set));
+        TRY(n = in.read_all_into(buf));
+        TEST_EQUAL(n, data.size() - 300);
+        TEST(buf == data.substr(300));
+        TEST_EQUAL(in.read_all_into(buf), 0u);
+    }
+
+    {
+        std::jthread writer;
+        Fdio in;
+        TRY(in = pipe_from(data, writer));
+        TEST(! in.can_seek());
+        buf = "leftover";
+        TRY(n = in.read_all_into(buf));
+        TEST_EQUAL(n, data.size());
+        TEST(buf == data);
+    }
+
+    {
+        std::jthread writer;
+        Fdio in;
+        std::string s;
+        TRY(in = pipe_from(data, writer));
+        TRY(s = in.read_all());
+        TEST(s == data);
+    }
+
+    TRY(fs::remove(test_file));
+    TEST(! fs::exists(test_file));
+
+}
+
+void test_rs_core_io_read_all_benchmark() {
+
+    static constexpr auto data_size = 64uz << 20;
+    static constexpr int iterations = 10;
+
+    std::string data(data_size, 'x');
+    std::string buf;
+
+    {
+        Fdio out(test_file, IO::write_only);
+        TRY(out.write_str(data));
+    }
+
+    auto report = [] (const char* name, auto start, auto stop) {
+        auto total = duration_cast<duration<double>>(stop - start).count();
+        auto rate = static_cast<std::uint64_t>(static_cast<double>(data_size) * iterations / total / 1e6);
+        std::println("... read_all {} = {} MB/s", name, rate);
+    };
+
+    auto start = system_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        Cstdio in(test_file);
+        buf = in.read_all();
+    }
+
+    auto stop = system_clock::now();
+    report("(file)", start, stop);
+    start = system_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        Cstdio in(test_file);
+        in.read_all_into(buf);
+    }
+
+    stop = system_clock::now();
+    report("into (file)", start, stop);
+    start = system_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        std::jthread writer;
+        auto in = pipe_from(data, writer);
+        buf = in.read_all();
+    }
+
+    stop = system_clock::now();
+    report("(pipe)", start, stop);
+    start = system_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        std::jthread writer;
+        auto in = pipe_from(data, writer);
+        in.read_all_into(buf);
+    }
+
+    stop = system_clock::now();
+    report("into (pipe)", start, stop);
+
+    TRY(fs::remove(test_file));
+
+}
@@ -1,20 +1,48 @@
 #include "rs-core/log.hpp"
 #include "rs-core/io.hpp"
 #include "rs-core/unit-test.hpp"
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <filesystem>
 #include <format>
 #include <memory>
+#include <print>
+#include <semaphore>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace RS;
+using namespace std::chrono;
 
 namespace {
 
     const inline std::filesystem::path logfile{"__log_test__"};
 
+    std::vector<std::string> read_log() {
+        Cstdio in(logfile);
+        std::vector<std::string> lines;
+        for (auto line = in.read_line(); ! line.empty(); line = in.read_line()) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    struct Counter {
+        int value = 0;
+    };
+
 }
 
+template <>
+struct std::formatter<const Counter*>:
+std::formatter<int> {
+    auto format(const Counter* c, std::format_context& ctx) const {
+        return std::formatter<int>::format(c->value, ctx);
+    }
+};
+
 void test_rs_core_log_message() {
 
     TRY(std::filesystem::remove(logfile));
@@ -312,3 +340,354 @@ void test_rs_core_log_function_context() {
     TEST(! std::filesystem::exists(logfile));
 
 }
+
+void test_rs_core_log_flush() {
+
+    TRY(std::filesystem::remove(logfile));
+    TEST(! std::filesystem::exists(logfile));
+
+    {
+
+        Log log(logfile, Log::none);
+        Log::flush_policy fp;
+
+        TRY(fp = log.policy());
+        TEST_EQUAL(fp.messages, 1u);
+        TEST_EQUAL(fp.interval.count(), 0);
+        TRY(log.flush());
+
+        // Never flush automatically
+
+        TRY(log.set_policy({0, 0ms}));
+        TRY(fp = log.policy());
+        TEST_EQUAL(fp.messages, 0u);
+
+        for (int i = 0; i < 1000; ++i) {
+            TRY(log({"Message {}", i}));
+        }
+
+        TRY(log.flush());
+        auto lines = read_log();
+        TEST_EQUAL(lines.size(), 1000u);
+        TEST_EQUAL(lines.front(), "Message 0\n");
+        TEST_EQUAL(lines.back(), "Message 999\n");
+
+        // Flush on a timer
+
+        TRY(log.set_policy({0, 20ms}));
+        TRY(log({"Timed"}));
+        std::this_thread::sleep_for(500ms);
+        lines = read_log();
+        TEST_EQUAL(lines.size(), 1001u);
+        TEST_EQUAL(lines.back(), "Timed\n");
+
+        // Flush from several threads at once
+
+        std::vector<std::jthread> threads;
+
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([&log, i] {
+                for (int j = 0; j < 100; ++j) {
+                    TRY(log({"Thread {} message {}", i, j}));
+                    if (j % 10 == 0) {
+                        TRY(log.flush());
+                    }
+                }
+            });
+        }
+
+        threads.clear();
+        TRY(log.flush());
+        lines = read_log();
+        TEST_EQUAL(lines.size(), 1401u);
+
+    }
+
+    TRY(std::filesystem::remove(logfile));
+    TEST(! std::filesystem::exists(logfile));
+
+}
+
+void test_rs_core_log_threads() {
+
+    static constexpr int threads = 8;
+    static constexpr int messages = 5000;
+
+    TRY(std::filesystem::remove(logfile));
+    TEST(! std::filesystem::exists(logfile));
+
+    {
+
+        Log log(logfile, Log::none);
+        std::vector<std::jthread> workers;
+
+        TEST(log.on_overflow() == Log::overflow::block);
+        TEST_EQUAL(log.buffer_size(), Log::default_buffer_size);
+        TRY(log.set_buffer_size(16));
+        TEST_EQUAL(log.buffer_size(), 16u);
+
+        for (int i = 0; i < threads; ++i) {
+            workers.emplace_back([&log, i] {
+                for (int j = 0; j < messages; ++j) {
+                    TRY(log({"{} {}", i, j}));
+                }
+            });
+        }
+
+        workers.clear();
+        TRY(log.flush());
+        TEST_EQUAL(log.dropped(), 0u);
+
+        // Every message is written, and each thread's messages are in order
+
+        auto lines = read_log();
+        std::vector<int> next(threads, 0);
+        TEST_EQUAL(lines.size(), static_cast<std::size_t>(threads * messages));
+
+        for (auto& line: lines) {
+            auto space = line.find(' ');
+            auto i = std::stoi(line.substr(0, space));
+            auto j = std::stoi(line.substr(space + 1));
+            TEST_EQUAL(j, next[static_cast<std::size_t>(i)]);
+            next[static_cast<std::size_t>(i)] = j + 1;
+        }
+
+    }
+
+    TRY(std::filesystem::remove(logfile));
+    TEST(! std::filesystem::exists(logfile));
+
+}
+
+void test_rs_core_log_flush_handoff() {
+
+    // An entry logged by one thread before another thread calls flush()
+    // must be written by the time flush() returns
+
+    static constexpr int rounds = 200;
+
+    TRY(std::filesystem::remove(logfile));
+    TEST(! std::filesystem::exists(logfile));
+
+    {
+
+        Log log(logfile, Log::none);
+        std::binary_semaphore go {0};
+        std::binary_semaphore done {0};
+        auto missing = 0;
+
+        std::jthread other([&log, &go, &done] {
+            for (int i = 0; i < rounds; ++i) {
+                go.acquire();
+                log({"Round {}", i});
+                done.release();
+            }
+        });
+
+        for (int i = 0; i < rounds; ++i) {
+            log({"Main {}", i});
+            go.release();
+            done.acquire();
+            TRY(log.flush());
+            auto lines = read_log();
+            if (lines.empty() || lines.back() != std::format("Round {}\n", i)) {
+                ++missing;
+            }
+        }
+
+        TEST_EQUAL(missing, 0);
+
+    }
+
+    TRY(std::filesystem::remove(logfile));
+    TEST(! std::filesystem::exists(logfile));
+
+}
+
+void test_rs_core_log_overflow() {
+
+    static constexpr int messages = 100'000;
+
+    TRY(std::filesystem::remove(logfile));
+    TEST(! std::filesystem::exists(logfile));
+
+    for (auto op: {Log::overflow::drop, Log::overflow::report}) {
+
+        std::vector<std::string> lines;
+        std::uint64_t dropped = 0;
+
+        {
+            Log log(logfile, Log::none);
+            TRY(log.set_on_overflow(op));
+            TEST(log.on_overflow() == op);
+            TRY(log.set_buffer_size(4));
+            for (int i = 0; i < messages; ++i) {
+                TRY(log({"Message {}", i}));
+            }
+            TRY(log.flush());
+            dropped = log.dropped();
+        }
+
+        TRY(lines = read_log());
+        std::uint64_t written = 0;
+        std::uint64_t reported = 0;
+
+        for (auto& line: lines) {
+            if (line.starts_with("Message ")) {
+                ++written;
+            } else if (line.ends_with(" log entries dropped\n")) {
+                reported += std::stoull(line);
+            }
+        }
+
+        TEST_EQUAL(written + dropped, static_cast<std::uint64_t>(messages));
+
+        if (op == Log::overflow::report) {
+            TEST_EQUAL(reported, dropped);
+        } else {
+            TEST_EQUAL(reported, 0u);
+        }
+
+    }
+
+    TRY(std::filesystem::remove(logfile));
+    TEST(! std::filesystem::exists(logfile));
+
+}
+
+void test_rs_core_log_deferred() {
+
+    TRY(std::filesystem::remove(logfile));
+    TEST(! std::filesystem::exists(logfile));
+
+    std::string str = "hello";
+    std::string long_str(200, 'x');
+    const char* ptr = "world";
+    char array[] = "array";
+    Counter counter{1};
+    const Counter* counter_ptr = &counter;
+    std::vector<std::string> lines;
+
+    {
+        Log log(logfile, Log::none);
+        TRY(log({"{} {} {} {}", str, std::string_view{str}, ptr, array}));
+        str = "changed";
+        array[0] = 'A';
+        TRY(log({"Counter {}", counter_ptr}));
+        counter.value = 2;
+        TRY(log({"Null {} {}", nullptr, static_cast<const void*>(nullptr)}));
+        TRY(log({"{} {:.3f} {} {} {:x}", 42, 3.14159, true, 'z', 255u}));
+        TRY(log({"{:>8}|{:<6}|{:^7}", std::string{"right"}, "left", "mid"}));
+        TRY(log({"Long {}", long_str}));
+        TRY(log({"Mixed {} {} {}", 86, long_str.substr(0, 100), 99}));
+        TRY(log({"Duration {}", 250ms}));
+        TRY(log({"Literal only"}));
+    }
+
+    TRY(lines = read_log());
+    TEST_EQUAL(lines.size(), 9u);
+
+    if (lines.size() == 9) {
+        TEST_EQUAL(lines[0], "hello hello world array\n");
+        TEST_EQUAL(lines[1], "Counter 1\n");
+        TEST_EQUAL(lines[2], "Null 0x0 0x0\n");
+        TEST_EQUAL(lines[3], "42 3.142 true z ff\n");
+        TEST_EQUAL(lines[4], "   right|left  |  mid  \n");
+        TEST_EQUAL(lines[5], "Long " + long_str + "\n");
+        TEST_EQUAL(lines[6], "Mixed 86 " + long_str.substr(0, 100) + " 99\n");
+        TEST_EQUAL(lines[7], "Duration 250ms\n");
+        TEST_EQUAL(lines[8], "Literal only\n");
+    }
+
+    TRY(std::filesystem::remove(logfile));
+    TEST(! std::filesystem::exists(logfile));
+
+}
+
+void test_rs_core_log_benchmark() {
+
+    static constexpr int iterations = 200'000;
+
+    struct test_case {
+        const char* name;
+        Log::flush_policy policy;
+    };
+
+    static const test_case cases[] = {
+        { "every message",      { 1, 0ms }      },
+        { "every 1000",         { 1000, 0ms }   },
+        { "every 100 ms",       { 0, 100ms }    },
+    };
+
+    for (auto& tc: cases) {
+
+        TRY(std::filesystem::remove(logfile));
+        auto start = system_clock::now();
+
+        {
+            Log log(logfile, Log::time | Log::file | Log::line);
+            log.set_policy(tc.policy);
+            for (int i = 0; i < iterations; ++i) {
+                log({"Message number {} with a payload of {}", i, 3.14159});
+            }
+        }
+
+        auto stop = system_clock::now();
+        auto total = duration_cast<duration<double>>(stop - start).count();
+        auto rate = static_cast<std::uint64_t>(iterations / total);
+        std::println("... Messages per second (flush {}) = {}", tc.name, rate);
+
+    }
+
+    // Time spent in the calling threads only
+
+    for (auto threads: {1, 4, 16}) {
+
+        TRY(std::filesystem::remove(logfile));
+        Log log(logfile, Log::time | Log::file | Log::line);
+        std::vector<std::jthread> workers;
+        auto per_thread = iterations / threads;
+        auto start = system_clock::now();
+
+        for (int i = 0; i < threads; ++i) {
+            workers.emplace_back([&log, per_thread] {
+                for (int j = 0; j < per_thread; ++j) {
+                    log({"Message number {} with a payload of {}", j, 3.14159});
+                }
+            });
+        }
+
+        workers.clear();
+        auto stop = system_clock::now();
+        log.flush();
+        auto total = duration_cast<duration<double>>(stop - start).count();
+        auto rate = static_cast<std::uint64_t>(per_thread * threads / total);
+        std::println("... Messages per second ({} threads, caller side) = {}", threads, rate);
+
+    }
+
+    // Cost of a single call with a buffer large enough never to block
+
+    {
+
+        TRY(std::filesystem::remove(logfile));
+        Log log(logfile, Log::time | Log::file | Log::line);
+        log.set_buffer_size(iterations);
+        std::string name = "payload";
+        auto start = system_clock::now();
+
+        for (int i = 0; i < iterations; ++i) {
+            log({"Message number {} with a {} of {}", i, name, 3.14159});
+        }
+
+        auto stop = system_clock::now();
+        log.flush();
+        auto total = static_cast<double>(duration_cast<nanoseconds>(stop - start).count());
+        auto each = static_cast<std::uint64_t>(total / iterations);
+        std::println("... Caller side latency = {} ns", each);
+
+    }
+
+    TRY(std::filesystem::remove(logfile));
+
+}
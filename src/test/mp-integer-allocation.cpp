@@ -0,0 +1,177 @@
+#include "rs-core/mp-integer.hpp"
+#include "rs-core/unit-test.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <print>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace RS;
+using namespace RS::UnitTest;
+
+// These tests replace the global allocator to count heap allocations made by
+// the current thread, so they are built as a separate executable instead of
+// being part of the main unit test harness
+
+namespace {
+
+    thread_local std::size_t allocations = 0;
+
+}
+
+void* operator new(std::size_t n) {
+    ++allocations;
+    if (auto ptr = std::malloc(n == 0 ? 1 : n)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void* operator new[](std::size_t n) {
+    return ::operator new(n);
+}
+
+void operator delete(void* ptr, std::size_t /*n*/) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t /*n*/) noexcept {
+    std::free(ptr);
+}
+
+void test_rs_core_mp_integer_allocation_natural() {
+
+    Natural x, y, z, q, r;
+    bool b = false;
+    auto count = allocations;
+
+    TRY(x = 123'456'789u);
+    TRY(y = 0xffff'ffff'ffff'ffffull);
+    TRY(z = x + y);
+    TRY(z = z * x);
+    TRY(z -= y);
+    TRY(z = z / x);
+    TRY(z = z % 1000u);
+    TRY(z = x + 42u);
+    TRY(z = 42u * x);
+    TRY(++z);
+    TRY(--z);
+    TRY(z <<= 70);
+    TRY(z >>= 35);
+    TRY(z = x & y);
+    TRY(z = x | y);
+    TRY(z = x ^ y);
+    TRY(z = y * y);
+    TRY(std::tie(q, r) = z.divide(x));
+    TRY(std::tie(q, r) = z.divide(y + 1u));
+    TRY(b = z > y);
+    TRY(b = z == 42u);
+    TRY(z.set_bit(200));
+    TRY(z.flip_bit(100));
+
+    TEST_EQUAL(allocations - count, 0u);
+    TEST(b == false);
+
+    TRY(z.set_bit(1000));
+    TEST(allocations - count > 0u);
+
+    // Fused operations reuse existing capacity
+
+    TRY(x = (Natural{1u} << 600) - 1u);
+    TRY(y = x >> 100);
+    TRY(z = x << 2000);
+    count = allocations;
+
+    TRY(z = x);
+    TRY(z.add_mul(x, y));
+    TRY(z.sub_mul(x, y));
+    TEST(z == x);
+    TRY(z.mul_add(y, x));
+    TRY(z.mul_sub(y, x));
+    TRY(z *= y);
+    TRY(z += x);
+
+    TEST_EQUAL(allocations - count, 0u);
+
+    // Temporaries are reused by the operators
+
+    count = allocations;
+    TRY(z = x * y + x);
+    TEST_EQUAL(allocations - count, 1u);
+    count = allocations;
+    TRY(z = y + (x * y - x));
+    TEST_EQUAL(allocations - count, 1u);
+
+}
+
+void test_rs_core_mp_integer_allocation_integer() {
+
+    Integer x, y, z, q, r;
+    auto count = allocations;
+
+    TRY(x = -123'456'789);
+    TRY(y = 0x7fff'ffff'ffff'ffffll);
+    TRY(z = x + y);
+    TRY(z = z * x);
+    TRY(z -= y);
+    TRY(z = z / x);
+    TRY(z = z % 1000);
+    TRY(z = - z);
+    TRY(z = x * y);
+    TRY(std::tie(q, r) = z.divide(x));
+
+    TEST_EQUAL(allocations - count, 0u);
+
+    TRY(x = - Integer{Natural{1u} << 600});
+    TRY(y = Natural{1u} << 500);
+    TRY(z = Natural{1u} << 2600);
+    count = allocations;
+
+    TRY(z = x);
+    TRY(z.add_mul(x, y));
+    TRY(z.sub_mul(x, y));
+    TEST(z == x);
+    TRY(z.mul_add(y, x));
+    TRY(z.mul_sub(y, x));
+    TRY(z -= x);
+
+    TEST_EQUAL(allocations - count, 0u);
+
+    count = allocations;
+    TRY(z = - (x * y) - x);
+    TEST_EQUAL(allocations - count, 1u);
+
+}
+
+int main(int argc, char** argv) {
+
+    main_args = std::vector<std::string>(argv + 1, argv + argc);
+    std::println("");
+    std::println("{}Running allocation tests{}", xhead, xreset);
+    std::println("{}{}{}", xrule, rule, xreset);
+
+    call_me_maybe(test_rs_core_mp_integer_allocation_natural, "test_rs_core_mp_integer_allocation_natural");
+    call_me_maybe(test_rs_core_mp_integer_allocation_integer, "test_rs_core_mp_integer_allocation_integer");
+
+    if (failures == 0) {
+        std::println("{}OK - all tests passed{}", xpass, xreset);
+    } else {
+        std::println("{}*** Test failures: {}{}", xfail, failures, xreset);
+    }
+
+    std::println("");
+
+    return failures;
+
+}
@@ -0,0 +1,64 @@
+#include "rs-core/bitwise-integer.hpp"
+#include "rs-core/mp-integer.hpp"
+#include "rs-core/unit-test.hpp"
+#include <chrono>
+#include <cstdint>
+#include <print>
+#include <string>
+
+using namespace RS;
+using namespace std::chrono;
+
+// Build with RS_CORE_32_BIT_WORDS defined to compare against 32-bit words
+
+void test_rs_core_mp_integer_benchmark() {
+
+    auto report = [] (const char* name, int iterations, auto start, auto stop) {
+        auto total = static_cast<double>(duration_cast<nanoseconds>(stop - start).count());
+        auto each = total / static_cast<double>(iterations);
+        std::println("... {} ({}-bit words) = {:.3f} us", name, 8 * sizeof(Uint1024::word_type), each / 1e3);
+    };
+
+    Natural x, y, z;
+    std::string s;
+
+    TRY(x = (Natural{1u} << 16'384) / 3u);
+    TRY(y = (Natural{1u} << 16'384) / 7u);
+
+    auto start = system_clock::now();
+
+    for (int i = 0; i < 1000; ++i) {
+        TRY(z = x * y);
+    }
+
+    auto stop = system_clock::now();
+    report("Natural 16k-bit multiply", 1000, start, stop);
+    TRY(x = (Natural{1u} << 131'072) / 7u);
+    start = system_clock::now();
+
+    for (int i = 0; i < 20; ++i) {
+        TRY(s = x.to_string());
+    }
+
+    stop = system_clock::now();
+    report("Natural 128k-bit to_string", 20, start, stop);
+    TEST_EQUAL(s.size(), 39'456u);
+
+    Uint1024 u, v, w;
+    TRY(u = ~ Uint1024{} / Uint1024{3});
+    TRY(v = ~ Uint1024{} / Uint1024{7});
+    start = system_clock::now();
+
+    for (int i = 0; i < 100'000; ++i) {
+        TRY(w = u * v);
+        TRY(u = w ^ v);
+    }
+
+    stop = system_clock::now();
+    report("Uint1024 multiply", 100'000, start, stop);
+
+    if (u == v) {
+        std::println("... !!!!!");
+    }
+
+}
@@ -144,3 +144,31 @@ void test_rs_core_mp_integer_signed_large_arithmetic() {
     TRY(x = -1);  TRY(y = -1);  TRY(z = x * y);  TEST_EQUAL(z.to_string(), "1");
 
 }
+
+void test_rs_core_mp_integer_signed_fused_arithmetic() {
+
+    Integer a, b, c, d, x;
+    std::string s;
+
+    TRY(a = Integer("123456789123456789123456789"));
+    TRY(b = Integer("987654321987654321"));
+    TRY(c = Integer("1357913579"));
+    TRY(d = - b);
+
+    TRY(x = a);    TRY(x.add_mul(d, c));  TRY(s = x.to_string());  TEST_EQUAL(s, "-1217692426061617283720468070");
+    TRY(x = a);    TRY(x.sub_mul(d, c));  TRY(s = x.to_string());  TEST_EQUAL(s, "1464606004308530861967381648");
+    TRY(x = - a);  TRY(x.add_mul(b, c));  TRY(s = x.to_string());  TEST_EQUAL(s, "1217692426061617283720468070");
+    TRY(x = - a);  TRY(x.sub_mul(b, c));  TRY(s = x.to_string());  TEST_EQUAL(s, "-1464606004308530861967381648");
+    TRY(x = d);    TRY(x.mul_add(c, a));  TRY(s = x.to_string());  TEST_EQUAL(s, "-1217692426061617283720468070");
+    TRY(x = d);    TRY(x.mul_sub(c, a));  TRY(s = x.to_string());  TEST_EQUAL(s, "-1464606004308530861967381648");
+    TRY(x = - a);  TRY(x.mul_sub(d, c));  TRY(s = x.to_string());  TEST_EQUAL(s, "121932631356500531469135800347203167754721690");
+    TRY(x = a);    TRY(x.sub_mul(a, 1));  TRY(s = x.to_string());  TEST_EQUAL(s, "0");
+    TRY(x = a);    TRY(x.sub_mul(x, 1));  TRY(s = x.to_string());  TEST_EQUAL(s, "0");
+    TRY(x = d);    TRY(x.mul_sub(1, x));  TRY(s = x.to_string());  TEST_EQUAL(s, "0");
+
+    TRY(x = - (a * b - c) + (b - a) * c);  TRY(s = x.to_string());  TEST_EQUAL(s, "-121932631524144180498468066532610576113634662");
+    TRY(x = c - a * b);                    TRY(s = x.to_string());  TEST_EQUAL(s, "-121932631356500531469135800347203167754721690");
+    TRY(x = a);  TRY(x -= x);              TRY(s = x.to_string());  TEST_EQUAL(s, "0");
+    TRY(x = d);  TRY(x -= a);              TRY(s = x.to_string());  TEST_EQUAL(s, "-123456790111111111111111110");
+
+}
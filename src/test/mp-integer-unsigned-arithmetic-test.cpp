@@ -1,6 +1,8 @@
 #include "rs-core/mp-integer.hpp"
 #include "rs-core/unit-test.hpp"
 #include <string>
+#include <tuple>
+#include <vector>
 
 using namespace RS;
 
@@ -78,6 +80,20 @@ void test_rs_core_mp_integer_unsigned_arithmetic() {
     TRY(z = x - y);
     TEST_EQUAL(z, Natural("123456789123456789122098875544320997765543210"));
 
+    // Saturation when both operands have the same number of words
+
+    TRY(x = Natural("123456789123456789123456789123456789123456788"));
+    TRY(y = Natural("123456789123456789123456789123456789123456789"));
+    TRY(z = x - y);
+    TEST_EQUAL(z, Natural{});
+    TRY(z = y - x);
+    TEST_EQUAL(z, Natural{1u});
+    TRY(z = x);
+    TRY(z -= z + 1u);
+    TEST_EQUAL(z, Natural{});
+    TRY(z = Natural{1000u} - Natural{1001u});
+    TEST_EQUAL(z, Natural{});
+
     TRY(x = Natural("123456789123456789123456789123456789123456789"));
     TRY(y = Natural("123456789"));
     TRY(q = x / y);
@@ -196,3 +212,160 @@ void test_rs_core_mp_integer_unsigned_bit_operations() {
     TEST(! x.get_bit(80));
 
 }
+
+void test_rs_core_mp_integer_unsigned_large_multiplication() {
+
+    auto k_threshold = Natural::karatsuba_threshold.load();
+    auto t_threshold = Natural::toom3_threshold.load();
+
+    Natural x, y, z;
+    std::string s, t;
+    std::vector<Natural> products;
+
+    for (auto n: {10uz, 100uz, 500uz, 2000uz}) {
+        TRY(x = (Natural{1u} << static_cast<int>(4 * n)) - 1u);
+        TRY(z = x * x);
+        TRY(s = z.to_string(16));
+        TRY(t = std::string(n - 1, 'f') + 'e' + std::string(n - 1, '0') + '1');
+        TEST_EQUAL(s, t);
+    }
+
+    TRY(x = {});
+    TRY(y = {});
+
+    for (auto i = 0u; i < 800u; ++i) {
+        TRY(x = (x << 32) + (i * 0x9e37'79b9u + 0x1234'5678u));
+        if (i < 500u) {
+            TRY(y = (y << 32) + (i * 0x85eb'ca6bu + 0x0bad'f00du));
+        }
+    }
+
+    TEST_EQUAL(x.bits(), 25597u);
+    TEST_EQUAL(y.bits(), 15996u);
+
+    for (auto [k,t]: {std::pair{1'000'000uz, 1'000'000uz}, {4uz, 1'000'000uz}, {4uz, 9uz}, {k_threshold, t_threshold}}) {
+        Natural::karatsuba_threshold = k;
+        Natural::toom3_threshold = t;
+        TRY(products.push_back(x * y));
+        TRY(products.push_back(y * x));
+        TRY(products.push_back(x * x));
+        TRY(products.push_back(x * (y >> 9000)));
+    }
+
+    Natural::karatsuba_threshold = k_threshold;
+    Natural::toom3_threshold = t_threshold;
+
+    REQUIRE(products.size() == 16u);
+
+    for (auto i = 4uz; i < products.size(); ++i) {
+        TEST_EQUAL(products[i], products[i % 4]);
+    }
+
+    TEST_EQUAL(products[0], products[1]);
+    TEST_EQUAL(products[0].bits(), 41592u);
+    TEST_EQUAL(products[2].bits(), 51193u);
+    TEST_EQUAL(products[3].bits(), 32592u);
+
+}
+
+void test_rs_core_mp_integer_unsigned_large_division() {
+
+    Natural x, y, q, r;
+    std::string s;
+
+    TRY(x = (Natural{1u} << 4000) - 1u);
+    TRY(y = (Natural{1u} << 2000) - 1u);
+    TRY(std::tie(q, r) = x.divide(y));
+    TEST_EQUAL(q, (Natural{1u} << 2000) + 1u);
+    TEST_EQUAL(r, Natural{});
+
+    TRY(y = (Natural{1u} << 1999) + 1u);
+    TRY(std::tie(q, r) = x.divide(y));
+    TEST_EQUAL(q * y + r, x);
+    TEST(r < y);
+
+    TRY(x = Natural("123456789123456789123456789123456789123456789123456789123456789"));
+    TRY(std::tie(q, r) = x.divide(Natural{1'000'000'007u}));
+    TRY(s = q.to_string());  TEST_EQUAL(s, "123456788259259271308641889962963559382711873444473675");
+    TRY(s = r.to_string());  TEST_EQUAL(s, "12141064");
+
+    TRY(x = {});
+    TRY(y = {});
+
+    for (auto i = 0u; i < 400u; ++i) {
+        TRY(x = (x << 32) + (i * 0x9e37'79b9u + 0x1234'5678u));
+        if (i < 150u) {
+            TRY(y = (y << 32) + (i * 0x85eb'ca6bu + 0x0bad'f00du));
+        }
+    }
+
+    for (auto shift: {0, 1, 31, 32, 33, 2000, 4700}) {
+        TRY(std::tie(q, r) = x.divide(y >> shift));
+        TEST_EQUAL(q * (y >> shift) + r, x);
+        TEST(r < (y >> shift));
+    }
+
+    TEST_THROW(x.divide(Natural{}), std::domain_error, "Division by zero");
+    TEST_THROW(Natural{}.divide(Natural{}), std::domain_error, "Division by zero");
+    TEST_THROW(x / Natural{}, std::domain_error, "Division by zero");
+    TEST_THROW(x % Natural{}, std::domain_error, "Division by zero");
+
+}
+
+void test_rs_core_mp_integer_unsigned_fused_arithmetic() {
+
+    auto k_threshold = Natural::karatsuba_threshold.load();
+    auto t_threshold = Natural::toom3_threshold.load();
+
+    Natural a, b, c, x, y, z;
+    std::string s;
+
+    TRY(a = Natural("123456789123456789123456789"));
+    TRY(b = Natural("987654321987654321"));
+    TRY(c = Natural("1357913579"));
+
+    TRY(x = a);  TRY(x.add_mul(b, c));   TRY(s = x.to_string());  TEST_EQUAL(s, "1464606004308530861967381648");
+    TRY(x = a);  TRY(x.sub_mul(b, c));   TRY(s = x.to_string());  TEST_EQUAL(s, "0");
+    TRY(x = a);  TRY(x.sub_mul(c, c));   TRY(s = x.to_string());  TEST_EQUAL(s, "123456787279527501090867548");
+    TRY(x = a);  TRY(x.mul_add(b, c));   TRY(s = x.to_string());  TEST_EQUAL(s, "121932631356500531469135800347203170470548848");
+    TRY(x = a);  TRY(x.mul_sub(b, c));   TRY(s = x.to_string());  TEST_EQUAL(s, "121932631356500531469135800347203167754721690");
+    TRY(x = c);  TRY(x.mul_sub(1u, a));  TRY(s = x.to_string());  TEST_EQUAL(s, "0");
+    TRY(x = {});  TRY(x.add_mul(b, c));  TEST_EQUAL(x, b * c);
+    TRY(x = a);  TRY(x.add_mul(b, {}));  TEST_EQUAL(x, a);
+    TRY(x = a);  TRY(x.mul_add({}, c));  TEST_EQUAL(x, c);
+
+    TRY(x = a);  TRY(x.add_mul(x, x));  TRY(s = x.to_string());  TEST_EQUAL(s, "15241578780673678546105778404511509639079409873647310");
+    TRY(x = a);  TRY(x.mul_add(x, x));  TRY(s = x.to_string());  TEST_EQUAL(s, "15241578780673678546105778404511509639079409873647310");
+    TRY(x = a);  TRY(x.sub_mul(x, 1u));  TRY(s = x.to_string());  TEST_EQUAL(s, "0");
+
+    TRY(x = a * b + c);               TRY(s = x.to_string());  TEST_EQUAL(s, "121932631356500531469135800347203170470548848");
+    TRY(x = c + a * b);               TRY(s = x.to_string());  TEST_EQUAL(s, "121932631356500531469135800347203170470548848");
+    TRY(x = (a + b) * (a - b));       TRY(s = x.to_string());  TEST_EQUAL(s, "15241578780673677570644718540161562960219480960219480");
+    TRY(x = a * b * c + a);           TRY(s = x.to_string());  TEST_EQUAL(s, "165573975842193261602656322809956887133337601372874540");
+    TRY(x = (a << 10) >> 10);         TEST_EQUAL(x, a);
+    TRY(x = (a | b) ^ (a & b) ^ b);   TEST_EQUAL(x, a);
+
+    TRY(x = {});
+    TRY(y = {});
+
+    for (auto i = 0u; i < 300u; ++i) {
+        TRY(x = (x << 32) + (i * 0x9e37'79b9u + 0x1234'5678u));
+        if (i < 200u) {
+            TRY(y = (y << 32) + (i * 0x85eb'ca6bu + 0x0bad'f00du));
+        }
+    }
+
+    for (auto [k,t]: {std::pair{1'000'000uz, 1'000'000uz}, {4uz, 9uz}, {k_threshold, t_threshold}}) {
+        Natural::karatsuba_threshold = k;
+        Natural::toom3_threshold = t;
+        TRY(z = a);  TRY(z.add_mul(x, y));  TEST_EQUAL(z, a + x * y);
+        TRY(z = x * y);  TRY(z.sub_mul(x, y - 1u));  TEST_EQUAL(z, x);
+        TRY(z = x);  TRY(z.mul_add(y, a));  TEST_EQUAL(z, x * y + a);
+        TRY(z = x);  TRY(z.mul_sub(y, x));  TEST_EQUAL(z, x * (y - 1u));
+        TRY(z = y);  TRY(z *= x);  TEST_EQUAL(z, x * y);
+    }
+
+    Natural::karatsuba_threshold = k_threshold;
+    Natural::toom3_threshold = t_threshold;
+
+}
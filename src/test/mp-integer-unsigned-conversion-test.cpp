@@ -296,3 +296,68 @@ void test_rs_core_mp_integer_unsigned_conversion_from_string() {
     TRY(x = Natural("0xabcdef123456789abcdef", 0));               TEST_EQUAL(x.to_string(), "12981175647918246886886895");
 
 }
+
+void test_rs_core_mp_integer_unsigned_large_string_conversion() {
+
+    Natural x, y;
+    std::string s, t;
+
+    TRY(x = 1u);
+    for (auto i = 0; i < 5000; ++i) {
+        TRY(x *= 10u);
+    }
+
+    TRY(s = x.to_string());
+    TEST_EQUAL(s.size(), 5001u);
+    TEST_EQUAL(s, "1" + std::string(5000, '0'));
+    TRY(y = Natural(s));
+    TEST_EQUAL(y, x);
+
+    TRY(x -= 1u);
+    TRY(s = x.to_string());
+    TEST_EQUAL(s, std::string(5000, '9'));
+    TRY(s = x.to_string(10, 5010));
+    TEST_EQUAL(s, std::string(10, '0') + std::string(5000, '9'));
+    TRY(y = Natural(s));
+    TEST_EQUAL(y, x);
+
+    TRY(x = (Natural{1u} << 20000) - 1u);
+    TRY(s = x.to_string(2));
+    TEST_EQUAL(s, std::string(20000, '1'));
+    TRY(s = x.to_string(16));
+    TEST_EQUAL(s, std::string(5000, 'f'));
+    TRY(y = Natural(s, 16));
+    TEST_EQUAL(y, x);
+
+    TRY(x = {});
+    for (auto i = 0u; i < 1000u; ++i) {
+        TRY(x = (x << 32) + (i * 0x9e37'79b9u + 0x1234'5678u));
+    }
+
+    for (auto base: {3u, 7u, 10u, 36u}) {
+        TRY(s = x.to_string(base));
+        TRY(y = Natural(s, base));
+        TEST_EQUAL(y, x);
+    }
+
+    // Large enough for the split points to use reciprocals
+
+    TRY(x = Natural(std::string(100'000, '9')));
+    TRY(s = x.to_string());
+    TEST_EQUAL(s, std::string(100'000, '9'));
+    TRY(x += 1u);
+    TRY(s = x.to_string());
+    TEST_EQUAL(s, "1" + std::string(100'000, '0'));
+    TRY(x += 1u);
+    TRY(s = x.to_string(10, 100'005));
+    TEST_EQUAL(s, "00001" + std::string(99'999, '0') + "1");
+
+    TRY(x = {});
+    for (auto i = 0u; i < 10'000u; ++i) {
+        TRY(x = (x << 32) + (i * 0x85eb'ca6bu + 0x0bad'f00du));
+    }
+    TRY(s = x.to_string());
+    TRY(y = Natural(s));
+    TEST_EQUAL(y, x);
+
+}
@@ -0,0 +1,184 @@
+#include "rs-core/parallel.hpp"
+#include "rs-core/thread-pool.hpp"
+#include "rs-core/unit-test.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace RS;
+using namespace std::chrono;
+
+void test_rs_core_parallel_for() {
+
+    ThreadPool pool;
+    std::vector<int> v(100'000, 0);
+
+    TRY(parallel_for(pool, 0uz, v.size(), [&v] (std::size_t i) { v[i] = static_cast<int>(i) * 2; }));
+    TEST(std::ranges::all_of(std::views::iota(0uz, v.size()), [&v] (std::size_t i) { return v[i] == static_cast<int>(i) * 2; }));
+
+    std::atomic<int> count {0};
+    TRY(parallel_for(pool, -50, 50, [&count] (int i) { count += i + 50; }, 7));
+    TEST_EQUAL(count.load(), 4950);
+    count = 0;
+    TRY(parallel_for(pool, 10, 10, [&count] (int) { ++count; }));
+    TRY(parallel_for(pool, 10, 5, [&count] (int) { ++count; }));
+    TEST_EQUAL(count.load(), 0);
+
+    // Irregular workload
+
+    count = 0;
+    TRY(parallel_for(pool, 0, 1000, [&count] (int i) {
+        auto x = 0.0;
+        for (int j = 0; j < (i % 100 == 0 ? 100'000 : 10); ++j) {
+            x += std::sqrt(static_cast<double>(j));
+        }
+        if (x >= 0) {
+            ++count;
+        }
+    }));
+    TEST_EQUAL(count.load(), 1000);
+
+    TEST_THROW(parallel_for(pool, 0, 1000, [] (int i) {
+        if (i == 567) {
+            throw std::runtime_error("oops");
+        }
+    }), std::runtime_error, "oops");
+
+    // Index 0 is in the first piece to run, so most of the other pieces are
+    // abandoned before they start
+
+    count = 0;
+
+    TEST_THROW(parallel_for(pool, 0, 1000, [&count] (int i) {
+        if (i == 0) {
+            throw std::runtime_error("oops");
+        }
+        std::this_thread::sleep_for(100us);
+        ++count;
+    }, 1), std::runtime_error, "oops");
+
+    TEST(count.load() < 999);
+
+}
+
+void test_rs_core_parallel_transform() {
+
+    ThreadPool pool;
+    std::vector<int> in(50'000);
+    std::vector<std::string> out(in.size());
+    std::vector<std::string>::iterator it;
+    std::iota(in.begin(), in.end(), 0);
+
+    TRY(it = parallel_transform(pool, in, out.begin(), [] (int i) { return std::to_string(i); }));
+    TEST(it == out.end());
+    TEST_EQUAL(out[0], "0");
+    TEST_EQUAL(out[12'345], "12345");
+    TEST_EQUAL(out[49'999], "49999");
+
+    std::vector<int> empty;
+    TRY(it = parallel_transform(pool, empty, out.begin(), [] (int i) { return std::to_string(i); }));
+    TEST(it == out.begin());
+
+}
+
+void test_rs_core_parallel_reduce() {
+
+    ThreadPool pool;
+    std::vector<std::uint64_t> v(100'000);
+    std::uint64_t sum = 0;
+    std::string str;
+    std::iota(v.begin(), v.end(), 1);
+
+    TRY(sum = parallel_reduce(pool, v, std::uint64_t{0}, std::plus<>{}));
+    TEST_EQUAL(sum, 5'000'050'000ull);
+    TRY(sum = parallel_reduce(pool, v, std::uint64_t{42}, std::plus<>{}, 1000));
+    TEST_EQUAL(sum, 5'000'050'042ull);
+    TRY(sum = parallel_reduce(pool, std::vector<std::uint64_t>{}, std::uint64_t{42}, std::plus<>{}));
+    TEST_EQUAL(sum, 42u);
+
+    // Associative but not commutative
+
+    std::vector<std::string> words;
+    std::string expect;
+
+    for (char c = 'a'; c <= 'z'; ++c) {
+        for (int i = 0; i < 100; ++i) {
+            words.push_back(std::string(1, c));
+            expect += c;
+        }
+    }
+
+    TRY(str = parallel_reduce(pool, words, std::string{">"}, std::plus<>{}, 3));
+    TEST_EQUAL(str, ">" + expect);
+
+}
+
+void test_rs_core_parallel_sort() {
+
+    ThreadPool pool;
+    std::mt19937 rng{42};
+
+    for (auto n: {0uz, 1uz, 100uz, 1000uz, 5000uz, 100'000uz}) {
+
+        std::vector<int> v(n);
+        std::uniform_int_distribution<int> dist{0, static_cast<int>(n / 3)};
+        std::ranges::generate(v, [&] { return dist(rng); });
+        auto expect = v;
+        std::ranges::sort(expect);
+
+        TRY(parallel_sort(pool, v));
+        TEST(v == expect);
+
+        std::ranges::shuffle(v, rng);
+        TRY(parallel_sort(pool, v, std::ranges::less{}, 100));
+        TEST(v == expect);
+
+        std::ranges::shuffle(v, rng);
+        TRY(parallel_sort(pool, v, std::greater<>{}, 100));
+        std::ranges::reverse(expect);
+        TEST(v == expect);
+
+    }
+
+    std::vector<std::string> s(20'000);
+    std::ranges::generate(s, [&] { return std::to_string(rng()); });
+    auto expect = s;
+    std::ranges::sort(expect);
+    TRY(parallel_sort(pool, s, std::ranges::less{}, 500));
+    TEST(s == expect);
+
+}
+
+void test_rs_core_parallel_nested() {
+
+    // Parallel algorithms called from inside a job run other queued jobs
+    // while waiting, so they do not deadlock even on a small pool
+
+    ThreadPool pool{2};
+    std::vector<std::vector<int>> vs(8, std::vector<int>(10'000));
+    std::mt19937 rng{42};
+
+    for (auto& v: vs) {
+        std::ranges::generate(v, [&] { return static_cast<int>(rng() % 1000); });
+    }
+
+    TRY(parallel_for(pool, 0uz, vs.size(), [&] (std::size_t i) {
+        parallel_sort(pool, vs[i], std::ranges::less{}, 100);
+    }, 1));
+
+    for (auto& v: vs) {
+        TEST(std::ranges::is_sorted(v));
+    }
+
+}
@@ -3,12 +3,15 @@
 #include "rs-core/random.hpp"
 #include "rs-core/unit-test.hpp"
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <future>
 #include <mutex>
 #include <print>
 #include <random>
 #include <ranges>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <thread>
@@ -78,6 +81,140 @@ void test_rs_core_thread_pool_class() {
 
 }
 
+void test_rs_core_thread_pool_submit() {
+
+    ThreadPool pool;
+    std::future<int> f1, f2;
+    std::future<std::string> f3;
+    std::future<void> f4;
+    std::string s;
+    int m = 0;
+    int n = 0;
+
+    TRY(f1 = pool.submit([] { return 42; }));
+    TRY(f2 = pool.submit([] () -> int { throw std::runtime_error("oops"); }));
+    TRY(f3 = pool.submit([] { return std::string{alphabet()}; }));
+    TRY(f4 = pool.submit([&n] { n = 86; }));
+
+    TRY(m = f1.get());
+    TEST_EQUAL(m, 42);
+    TEST_THROW(f2.get(), std::runtime_error, "oops");
+    TRY(s = f3.get());
+    TEST_EQUAL(s, alphabet());
+    TRY(f4.get());
+    TEST_EQUAL(n, 86);
+
+}
+
+void test_rs_core_thread_pool_task_group() {
+
+    ThreadPool pool{8};
+    std::atomic<int> slow_count {0};
+    std::atomic<int> fast_count {0};
+
+    {
+
+        TaskGroup slow{pool};
+        TaskGroup fast{pool};
+        TEST(&slow.pool() == &pool);
+
+        std::promise<void> gate;
+        auto gate_open = gate.get_future().share();
+
+        for (int i = 0; i < 4; ++i) {
+            TRY(slow([&slow_count, gate_open] {
+                gate_open.wait();
+                ++slow_count;
+            }));
+        }
+
+        for (int i = 0; i < 100; ++i) {
+            TRY(fast([&] { ++fast_count; }));
+        }
+
+        TRY(fast.wait());
+        TEST_EQUAL(fast_count.load(), 100);
+        TEST_EQUAL(slow_count.load(), 0);
+        TEST(! slow.poll());
+        TRY(gate.set_value());
+        TRY(slow.wait());
+        TEST_EQUAL(slow_count.load(), 4);
+        TEST(slow.poll());
+        TEST(fast.poll());
+
+        TRY(fast([] { throw std::runtime_error("oops"); }));
+        TRY(fast([&] { ++fast_count; }));
+        TEST_THROW(fast.wait(), std::runtime_error, "oops");
+        TEST_EQUAL(fast_count.load(), 101);
+        TRY(fast.wait());
+
+        std::future<int> f;
+        TRY(f = fast.submit([] { return 42; }));
+        TEST(fast.wait_for(5s));
+        TEST_EQUAL(f.get(), 42);
+
+        TRY(slow([&] {
+            std::this_thread::sleep_for(200ms);
+            ++slow_count;
+        }));
+
+        TEST(! slow.wait_for(10ms));
+        TEST(slow.wait_for(5s));
+        TEST_EQUAL(slow_count.load(), 5);
+
+        for (int i = 0; i < 100; ++i) {
+            TRY(slow([&] {
+                std::this_thread::sleep_for(10ms);
+                ++slow_count;
+            }));
+        }
+
+        TRY(pool.clear());
+        TEST(slow.poll());
+        TEST(slow_count < 105);
+
+    }
+
+    {
+
+        // A timed wait inside a job runs the group's jobs itself, even when
+        // every other worker is busy
+
+        std::atomic<std::size_t> blocked {0};
+        std::atomic<bool> release {false};
+        std::atomic<bool> done {false};
+
+        for (auto i = 1uz; i < pool.threads(); ++i) {
+            TRY(pool.insert([&] {
+                ++blocked;
+                while (! release) {
+                    std::this_thread::yield();
+                }
+            }));
+        }
+
+        TRY(pool.insert([&] {
+            while (blocked + 1 < pool.threads()) {
+                std::this_thread::yield();
+            }
+            TaskGroup inner(pool);
+            std::atomic<int> inner_count {0};
+            for (int i = 0; i < 10; ++i) {
+                inner([&inner_count] { ++inner_count; });
+            }
+            done = inner.wait_for(10s) && inner_count == 10;
+            release = true;
+        }));
+
+        TRY(pool.wait());
+        TEST(done);
+
+    }
+
+    TRY(pool.wait());
+
+}
+
 void test_rs_core_thread_pool_benchmark() {
 
     static constexpr int iterations = 1'000'000;
@@ -109,3 +246,94 @@ void test_rs_core_thread_pool_benchmark() {
     }
 
 }
+
+void test_rs_core_thread_pool_latency() {
+
+    static constexpr int iterations = 10'000;
+
+    ThreadPool pool;
+    auto start = system_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        TRY(pool.submit([] {}).get());
+    }
+
+    auto stop = system_clock::now();
+    auto total = static_cast<double>(duration_cast<nanoseconds>(stop - start).count());
+    auto each = static_cast<std::uint64_t>(total / static_cast<double>(iterations));
+    std::println("... Submit to completion latency = {} ns", each);
+
+    start = system_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        TRY(pool.insert([] {}));
+        TRY(pool.wait());
+    }
+
+    stop = system_clock::now();
+    total = static_cast<double>(duration_cast<nanoseconds>(stop - start).count());
+    each = static_cast<std::uint64_t>(total / static_cast<double>(iterations));
+    std::println("... Insert to wait latency = {} ns", each);
+
+}
+
+void test_rs_core_thread_pool_stealing() {
+
+    // Jobs queued behind a slow job on the same worker must be stolen by
+    // the other workers
+
+    ThreadPool pool{4};
+    std::atomic<int> count {0};
+    std::atomic<bool> finished {false};
+    std::vector<ThreadPool::worker_stats> stats;
+
+    TRY(pool.insert([&] {
+        for (int i = 0; i < 100; ++i) {
+            pool.insert([&count] { ++count; });
+        }
+        auto deadline = ThreadPool::clock::now() + 5s;
+        while (count < 100 && ThreadPool::clock::now() < deadline) {
+            std::this_thread::sleep_for(1ms);
+        }
+        finished = count == 100;
+    }));
+
+    TRY(pool.wait());
+    TEST_EQUAL(count.load(), 100);
+    TEST(finished);
+
+    TRY(stats = pool.stats());
+    TEST_EQUAL(stats.size(), 4u);
+
+    auto executed = 0uz;
+    auto stolen = 0uz;
+    auto high_water = 0uz;
+    auto inject_high_water = 0uz;
+
+    for (auto& s: stats) {
+        executed += s.jobs_executed;
+        stolen += s.jobs_stolen;
+        high_water = std::max(high_water, s.deque_high_water);
+        inject_high_water = std::max(inject_high_water, s.inject_high_water);
+    }
+
+    TEST_EQUAL(executed, 101u);
+    TEST_EQUAL(stolen, 100u);
+    TEST_IN_RANGE(high_water, 1u, 100u);
+    TEST_EQUAL(inject_high_water, 1u);
+
+    // Every worker is idle now, so each one's idle time is non-zero and
+    // keeps growing
+
+    std::vector<ThreadPool::worker_stats> later;
+    TRY(stats = pool.stats());
+    std::this_thread::sleep_for(1ms);
+    TRY(later = pool.stats());
+    TEST_EQUAL(later.size(), stats.size());
+
+    for (auto i = 0uz; i < stats.size() && i < later.size(); ++i) {
+        TEST(stats[i].idle_time > ThreadPool::clock::duration{});
+        TEST(later[i].idle_time > stats[i].idle_time);
+    }
+
+}
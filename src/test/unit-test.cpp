@@ -36,6 +36,10 @@ void test_rs_core_arithmetic_int_power();
 void test_rs_core_arithmetic_bitmask_functions();
 void test_rs_core_arithmetic_angle_conversions();
 void test_rs_core_arithmetic_geometry_functions();
+void test_rs_core_async_io_read_write();
+void test_rs_core_async_io_errors();
+void test_rs_core_async_io_thread_pool();
+void test_rs_core_async_io_benchmark();
 void test_rs_core_astronomy_constants();
 void test_rs_core_astronomy_mass_density();
 void test_rs_core_astronomy_surface_gravity();
@@ -60,6 +64,13 @@ void test_rs_core_character_properties();
 void test_rs_core_character_string_case_conversion();
 void test_rs_core_compress_single_block();
 void test_rs_core_compress_multiple_blocks();
+void test_rs_core_compress_stream_encode();
+void test_rs_core_compress_stream_decode();
+void test_rs_core_compress_parallel_encode();
+void test_rs_core_compress_size_hint();
+void test_rs_core_compress_lz4();
+void test_rs_core_compress_context();
+void test_rs_core_compress_benchmark();
 void test_rs_core_constants();
 void test_rs_core_dice_basic_statistics();
 void test_rs_core_dice_basic_formatting();
@@ -111,6 +122,16 @@ void test_rs_core_io_string_buffer_external();
 void test_rs_core_io_string_buffer_byte_io();
 void test_rs_core_io_string_buffer_formatting();
 void test_rs_core_io_string_buffer_line_iterator();
+void test_rs_core_io_buffered_line_views();
+void test_rs_core_io_buffered_mixed_io();
+void test_rs_core_io_mmap_file_class();
+void test_rs_core_io_mmap_file_line_views();
+void test_rs_core_io_fdio_class();
+void test_rs_core_io_fdio_vector_io();
+void test_rs_core_io_fdio_positional_io();
+void test_rs_core_io_read_all_into();
+void test_rs_core_io_read_all_benchmark();
+void test_rs_core_io_line_benchmark();
 void test_rs_core_iterator_concepts();
 void test_rs_core_iterator_tags();
 void test_rs_core_iterator_input_iterators();
@@ -138,6 +159,12 @@ void test_rs_core_linear_algebra_transform_quaternions();
 void test_rs_core_log_message();
 void test_rs_core_log_context();
 void test_rs_core_log_function_context();
+void test_rs_core_log_flush();
+void test_rs_core_log_threads();
+void test_rs_core_log_flush_handoff();
+void test_rs_core_log_overflow();
+void test_rs_core_log_deferred();
+void test_rs_core_log_benchmark();
 void test_rs_core_markup_xml();
 void test_rs_core_markup_html();
 void test_rs_core_mp_integer_concepts();
@@ -147,6 +174,7 @@ void test_rs_core_mp_integer_hash_set();
 void test_rs_core_mp_integer_signed_arithmetic();
 void test_rs_core_mp_integer_signed_division();
 void test_rs_core_mp_integer_signed_large_arithmetic();
+void test_rs_core_mp_integer_signed_fused_arithmetic();
 void test_rs_core_mp_integer_signed_conversion_from_integer();
 void test_rs_core_mp_integer_signed_conversion_to_floating_point();
 void test_rs_core_mp_integer_signed_conversion_to_string();
@@ -154,12 +182,22 @@ void test_rs_core_mp_integer_signed_format();
 void test_rs_core_mp_integer_signed_conversion_from_string();
 void test_rs_core_mp_integer_unsigned_arithmetic();
 void test_rs_core_mp_integer_unsigned_bit_operations();
+void test_rs_core_mp_integer_unsigned_large_multiplication();
+void test_rs_core_mp_integer_unsigned_large_division();
+void test_rs_core_mp_integer_unsigned_fused_arithmetic();
 void test_rs_core_mp_integer_unsigned_construction_from_list();
 void test_rs_core_mp_integer_unsigned_conversion_from_integer();
 void test_rs_core_mp_integer_unsigned_conversion_to_floating_point();
 void test_rs_core_mp_integer_unsigned_conversion_to_string();
 void test_rs_core_mp_integer_unsigned_format();
 void test_rs_core_mp_integer_unsigned_conversion_from_string();
+void test_rs_core_mp_integer_unsigned_large_string_conversion();
+void test_rs_core_mp_integer_benchmark();
+void test_rs_core_parallel_for();
+void test_rs_core_parallel_transform();
+void test_rs_core_parallel_reduce();
+void test_rs_core_parallel_sort();
+void test_rs_core_parallel_nested();
 void test_rs_core_random_bit();
 void test_rs_core_random_enum();
 void test_rs_core_random_shuffle();
@@ -219,7 +257,11 @@ void test_rs_core_statistics_bivariate();
 void test_rs_core_statistics_combination();
 void test_rs_core_terminal_escape_codes();
 void test_rs_core_thread_pool_class();
+void test_rs_core_thread_pool_submit();
+void test_rs_core_thread_pool_task_group();
+void test_rs_core_thread_pool_stealing();
 void test_rs_core_thread_pool_benchmark();
+void test_rs_core_thread_pool_latency();
 void test_rs_core_topological_sorting();
 void test_rs_core_topological_sorting_reverse();
 void test_rs_core_typelist_size();
@@ -303,6 +345,10 @@ int main(int argc, char** argv) {
     call_me_maybe(test_rs_core_arithmetic_bitmask_functions, "test_rs_core_arithmetic_bitmask_functions");
     call_me_maybe(test_rs_core_arithmetic_angle_conversions, "test_rs_core_arithmetic_angle_conversions");
     call_me_maybe(test_rs_core_arithmetic_geometry_functions, "test_rs_core_arithmetic_geometry_functions");
+    call_me_maybe(test_rs_core_async_io_read_write, "test_rs_core_async_io_read_write");
+    call_me_maybe(test_rs_core_async_io_errors, "test_rs_core_async_io_errors");
+    call_me_maybe(test_rs_core_async_io_thread_pool, "test_rs_core_async_io_thread_pool");
+    call_me_maybe(test_rs_core_async_io_benchmark, "test_rs_core_async_io_benchmark");
     call_me_maybe(test_rs_core_astronomy_constants, "test_rs_core_astronomy_constants");
     call_me_maybe(test_rs_core_astronomy_mass_density, "test_rs_core_astronomy_mass_density");
     call_me_maybe(test_rs_core_astronomy_surface_gravity, "test_rs_core_astronomy_surface_gravity");
@@ -327,6 +373,13 @@ int main(int argc, char** argv) {
     call_me_maybe(test_rs_core_character_string_case_conversion, "test_rs_core_character_string_case_conversion");
     call_me_maybe(test_rs_core_compress_single_block, "test_rs_core_compress_single_block");
     call_me_maybe(test_rs_core_compress_multiple_blocks, "test_rs_core_compress_multiple_blocks");
+    call_me_maybe(test_rs_core_compress_stream_encode, "test_rs_core_compress_stream_encode");
+    call_me_maybe(test_rs_core_compress_stream_decode, "test_rs_core_compress_stream_decode");
+    call_me_maybe(test_rs_core_compress_parallel_encode, "test_rs_core_compress_parallel_encode");
+    call_me_maybe(test_rs_core_compress_size_hint, "test_rs_core_compress_size_hint");
+    call_me_maybe(test_rs_core_compress_lz4, "test_rs_core_compress_lz4");
+    call_me_maybe(test_rs_core_compress_context, "test_rs_core_compress_context");
+    call_me_maybe(test_rs_core_compress_benchmark, "test_rs_core_compress_benchmark");
     call_me_maybe(test_rs_core_constants, "test_rs_core_constants");
     call_me_maybe(test_rs_core_dice_basic_statistics, "test_rs_core_dice_basic_statistics");
     call_me_maybe(test_rs_core_dice_basic_formatting, "test_rs_core_dice_basic_formatting");
@@ -378,6 +431,16 @@ int main(int argc, char** argv) {
     call_me_maybe(test_rs_core_io_string_buffer_byte_io, "test_rs_core_io_string_buffer_byte_io");
     call_me_maybe(test_rs_core_io_string_buffer_formatting, "test_rs_core_io_string_buffer_formatting");
     call_me_maybe(test_rs_core_io_string_buffer_line_iterator, "test_rs_core_io_string_buffer_line_iterator");
+    call_me_maybe(test_rs_core_io_buffered_line_views, "test_rs_core_io_buffered_line_views");
+    call_me_maybe(test_rs_core_io_buffered_mixed_io, "test_rs_core_io_buffered_mixed_io");
+    call_me_maybe(test_rs_core_io_mmap_file_class, "test_rs_core_io_mmap_file_class");
+    call_me_maybe(test_rs_core_io_mmap_file_line_views, "test_rs_core_io_mmap_file_line_views");
+    call_me_maybe(test_rs_core_io_fdio_class, "test_rs_core_io_fdio_class");
+    call_me_maybe(test_rs_core_io_fdio_vector_io, "test_rs_core_io_fdio_vector_io");
+    call_me_maybe(test_rs_core_io_fdio_positional_io, "test_rs_core_io_fdio_positional_io");
+    call_me_maybe(test_rs_core_io_read_all_into, "test_rs_core_io_read_all_into");
+    call_me_maybe(test_rs_core_io_read_all_benchmark, "test_rs_core_io_read_all_benchmark");
+    call_me_maybe(test_rs_core_io_line_benchmark, "test_rs_core_io_line_benchmark");
     call_me_maybe(test_rs_core_iterator_concepts, "test_rs_core_iterator_concepts");
     call_me_maybe(test_rs_core_iterator_tags, "test_rs_core_iterator_tags");
     call_me_maybe(test_rs_core_iterator_input_iterators, "test_rs_core_iterator_input_iterators");
@@ -405,6 +468,12 @@ int main(int argc, char** argv) {
     call_me_maybe(test_rs_core_log_message, "test_rs_core_log_message");
     call_me_maybe(test_rs_core_log_context, "test_rs_core_log_context");
     call_me_maybe(test_rs_core_log_function_context, "test_rs_core_log_function_context");
+    call_me_maybe(test_rs_core_log_flush, "test_rs_core_log_flush");
+    call_me_maybe(test_rs_core_log_threads, "test_rs_core_log_threads");
+    call_me_maybe(test_rs_core_log_flush_handoff, "test_rs_core_log_flush_handoff");
+    call_me_maybe(test_rs_core_log_overflow, "test_rs_core_log_overflow");
+    call_me_maybe(test_rs_core_log_deferred, "test_rs_core_log_deferred");
+    call_me_maybe(test_rs_core_log_benchmark, "test_rs_core_log_benchmark");
     call_me_maybe(test_rs_core_markup_xml, "test_rs_core_markup_xml");
     call_me_maybe(test_rs_core_markup_html, "test_rs_core_markup_html");
     call_me_maybe(test_rs_core_mp_integer_concepts, "test_rs_core_mp_integer_concepts");
@@ -414,6 +483,7 @@ int main(int argc, char** argv) {
     call_me_maybe(test_rs_core_mp_integer_signed_arithmetic, "test_rs_core_mp_integer_signed_arithmetic");
     call_me_maybe(test_rs_core_mp_integer_signed_division, "test_rs_core_mp_integer_signed_division");
     call_me_maybe(test_rs_core_mp_integer_signed_large_arithmetic, "test_rs_core_mp_integer_signed_large_arithmetic");
+    call_me_maybe(test_rs_core_mp_integer_signed_fused_arithmetic, "test_rs_core_mp_integer_signed_fused_arithmetic");
     call_me_maybe(test_rs_core_mp_integer_signed_conversion_from_integer, "test_rs_core_mp_integer_signed_conversion_from_integer");
     call_me_maybe(test_rs_core_mp_integer_signed_conversion_to_floating_point, "test_rs_core_mp_integer_signed_conversion_to_floating_point");
     call_me_maybe(test_rs_core_mp_integer_signed_conversion_to_string, "test_rs_core_mp_integer_signed_conversion_to_string");
@@ -421,12 +491,22 @@ int main(int argc, char** argv) {
     call_me_maybe(test_rs_core_mp_integer_signed_conversion_from_string, "test_rs_core_mp_integer_signed_conversion_from_string");
     call_me_maybe(test_rs_core_mp_integer_unsigned_arithmetic, "test_rs_core_mp_integer_unsigned_arithmetic");
     call_me_maybe(test_rs_core_mp_integer_unsigned_bit_operations, "test_rs_core_mp_integer_unsigned_bit_operations");
+    call_me_maybe(test_rs_core_mp_integer_unsigned_large_multiplication, "test_rs_core_mp_integer_unsigned_large_multiplication");
+    call_me_maybe(test_rs_core_mp_integer_unsigned_large_division, "test_rs_core_mp_integer_unsigned_large_division");
+    call_me_maybe(test_rs_core_mp_integer_unsigned_fused_arithmetic, "test_rs_core_mp_integer_unsigned_fused_arithmetic");
     call_me_maybe(test_rs_core_mp_integer_unsigned_construction_from_list, "test_rs_core_mp_integer_unsigned_construction_from_list");
     call_me_maybe(test_rs_core_mp_integer_unsigned_conversion_from_integer, "test_rs_core_mp_integer_unsigned_conversion_from_integer");
     call_me_maybe(test_rs_core_mp_integer_unsigned_conversion_to_floating_point, "test_rs_core_mp_integer_unsigned_conversion_to_floating_point");
     call_me_maybe(test_rs_core_mp_integer_unsigned_conversion_to_string, "test_rs_core_mp_integer_unsigned_conversion_to_string");
     call_me_maybe(test_rs_core_mp_integer_unsigned_format, "test_rs_core_mp_integer_unsigned_format");
     call_me_maybe(test_rs_core_mp_integer_unsigned_conversion_from_string, "test_rs_core_mp_integer_unsigned_conversion_from_string");
+    call_me_maybe(test_rs_core_mp_integer_unsigned_large_string_conversion, "test_rs_core_mp_integer_unsigned_large_string_conversion");
+    call_me_maybe(test_rs_core_mp_integer_benchmark, "test_rs_core_mp_integer_benchmark");
+    call_me_maybe(test_rs_core_parallel_for, "test_rs_core_parallel_for");
+    call_me_maybe(test_rs_core_parallel_transform, "test_rs_core_parallel_transform");
+    call_me_maybe(test_rs_core_parallel_reduce, "test_rs_core_parallel_reduce");
+    call_me_maybe(test_rs_core_parallel_sort, "test_rs_core_parallel_sort");
+    call_me_maybe(test_rs_core_parallel_nested, "test_rs_core_parallel_nested");
     call_me_maybe(test_rs_core_random_bit, "test_rs_core_random_bit");
     call_me_maybe(test_rs_core_random_enum, "test_rs_core_random_enum");
     call_me_maybe(test_rs_core_random_shuffle, "test_rs_core_random_shuffle");
@@ -486,7 +566,11 @@ int main(int argc, char** argv) {
     call_me_maybe(test_rs_core_statistics_combination, "test_rs_core_statistics_combination");
     call_me_maybe(test_rs_core_terminal_escape_codes, "test_rs_core_terminal_escape_codes");
     call_me_maybe(test_rs_core_thread_pool_class, "test_rs_core_thread_pool_class");
+    call_me_maybe(test_rs_core_thread_pool_submit, "test_rs_core_thread_pool_submit");
+    call_me_maybe(test_rs_core_thread_pool_task_group, "test_rs_core_thread_pool_task_group");
+    call_me_maybe(test_rs_core_thread_pool_stealing, "test_rs_core_thread_pool_stealing");
     call_me_maybe(test_rs_core_thread_pool_benchmark, "test_rs_core_thread_pool_benchmark");
+    call_me_maybe(test_rs_core_thread_pool_latency, "test_rs_core_thread_pool_latency");
     call_me_maybe(test_rs_core_topological_sorting, "test_rs_core_topological_sorting");
     call_me_maybe(test_rs_core_topological_sorting_reverse, "test_rs_core_topological_sorting_reverse");
     call_me_maybe(test_rs_core_typelist_size, "test_rs_core_typelist_size");